@@ -0,0 +1,275 @@
+#include "xbase/x_target.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+
+#include "xfilesystem/private/x_checksum.h"
+
+#if defined(TARGET_PC) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <nmmintrin.h>
+#define X_CHECKSUM_CRC32C_SSE42
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define X_CHECKSUM_CRC32C_SSE42
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define X_CHECKSUM_CRC32C_ARM64
+#endif
+
+namespace xcore
+{
+    namespace xchecksum
+    {
+        static inline u32 read32(xbyte const* p) { return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24); }
+        static inline u64 read64(xbyte const* p) { return (u64)read32(p) | ((u64)read32(p + 4) << 32); }
+        static inline u64 rotl64(u64 x, s32 r) { return (x << r) | (x >> (64 - r)); }
+
+        // ------------------------------------------------------------------------------------------
+        // CRC-32C, scalar fallback uses a 256 entry table of the reflected polynomial 0x82F63B78
+        struct crc32c_table_t
+        {
+            crc32c_table_t()
+            {
+                for (u32 i = 0; i < 256; ++i)
+                {
+                    u32 crc = i;
+                    for (s32 j = 0; j < 8; ++j)
+                        crc = (crc & 1) ? ((crc >> 1) ^ 0x82F63B78) : (crc >> 1);
+                    m_table[i] = crc;
+                }
+            }
+            u32 m_table[256];
+        };
+        static crc32c_table_t sCrc32cTable;
+
+        static u32 crc32c_scalar(u32 crc, xbyte const* data, u64 size)
+        {
+            u32 const* table = sCrc32cTable.m_table;
+            for (u64 i = 0; i < size; ++i)
+                crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            return crc;
+        }
+
+#if defined(X_CHECKSUM_CRC32C_SSE42)
+#if defined(TARGET_PC)
+        static bool has_sse42()
+        {
+            s32 info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+        }
+#define X_CHECKSUM_TARGET_SSE42
+#else
+        // Runs during static initialization, before the CPU data of the compiler runtime is set up
+        static bool has_sse42()
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.2") != 0;
+        }
+#define X_CHECKSUM_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+        static bool const sHasCrc32Instruction = has_sse42();
+
+        X_CHECKSUM_TARGET_SSE42 static u32 crc32c_hw(u32 crc, xbyte const* data, u64 size)
+        {
+#if defined(_M_IX86)
+            while (size >= 4)
+            {
+                crc = _mm_crc32_u32(crc, read32(data));
+                data += 4;
+                size -= 4;
+            }
+#else
+            u64 crc64 = crc;
+            while (size >= 8)
+            {
+                crc64 = _mm_crc32_u64(crc64, read64(data));
+                data += 8;
+                size -= 8;
+            }
+            crc = (u32)crc64;
+#endif
+            while (size > 0)
+            {
+                crc = _mm_crc32_u8(crc, *data++);
+                size -= 1;
+            }
+            return crc;
+        }
+#elif defined(X_CHECKSUM_CRC32C_ARM64)
+        static bool const sHasCrc32Instruction = true;
+
+        static u32 crc32c_hw(u32 crc, xbyte const* data, u64 size)
+        {
+            while (size >= 8)
+            {
+                crc = __crc32cd(crc, read64(data));
+                data += 8;
+                size -= 8;
+            }
+            while (size > 0)
+            {
+                crc = __crc32cb(crc, *data++);
+                size -= 1;
+            }
+            return crc;
+        }
+#else
+        static bool const sHasCrc32Instruction = false;
+        static u32        crc32c_hw(u32 crc, xbyte const* data, u64 size) { return crc32c_scalar(crc, data, size); }
+#endif
+
+        static inline u32 crc32c(u32 crc, xbyte const* data, u64 size)
+        {
+            if (sHasCrc32Instruction)
+                return crc32c_hw(crc, data, size);
+            return crc32c_scalar(crc, data, size);
+        }
+
+        // ------------------------------------------------------------------------------------------
+        // xxHash64, the 4 independent lanes are what makes it fast, each lane only depends on itself
+        static u64 const PRIME64_1 = 0x9E3779B185EBCA87ULL;
+        static u64 const PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+        static u64 const PRIME64_3 = 0x165667B19E3779F9ULL;
+        static u64 const PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+        static u64 const PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+        static inline u64 xxh64_round(u64 acc, u64 input)
+        {
+            acc += input * PRIME64_2;
+            acc = rotl64(acc, 31);
+            return acc * PRIME64_1;
+        }
+
+        static inline u64 xxh64_merge(u64 acc, u64 val)
+        {
+            acc ^= xxh64_round(0, val);
+            return acc * PRIME64_1 + PRIME64_4;
+        }
+
+        static inline void xxh64_stripes(u64* lanes, xbyte const* data, u64 stripes)
+        {
+            u64 v1 = lanes[0];
+            u64 v2 = lanes[1];
+            u64 v3 = lanes[2];
+            u64 v4 = lanes[3];
+            for (u64 i = 0; i < stripes; ++i, data += 32)
+            {
+                v1 = xxh64_round(v1, read64(data + 0));
+                v2 = xxh64_round(v2, read64(data + 8));
+                v3 = xxh64_round(v3, read64(data + 16));
+                v4 = xxh64_round(v4, read64(data + 24));
+            }
+            lanes[0] = v1;
+            lanes[1] = v2;
+            lanes[2] = v3;
+            lanes[3] = v4;
+        }
+    } // namespace xchecksum
+
+    checksum_t::checksum_t(EChecksum algo) { reset(algo); }
+
+    void checksum_t::reset(EChecksum algo)
+    {
+        m_algo      = algo;
+        m_crc       = 0xFFFFFFFF;
+        m_total     = 0;
+        m_lanes[0]  = xchecksum::PRIME64_1 + xchecksum::PRIME64_2;
+        m_lanes[1]  = xchecksum::PRIME64_2;
+        m_lanes[2]  = 0;
+        m_lanes[3]  = 0 - xchecksum::PRIME64_1;
+        m_tail_size = 0;
+    }
+
+    void checksum_t::update(xbyte const* data, u64 size)
+    {
+        m_total += size;
+        if (m_algo == Checksum_CRC32C)
+        {
+            m_crc = xchecksum::crc32c(m_crc, data, size);
+            return;
+        }
+
+        // Complete a pending stripe first
+        if (m_tail_size > 0)
+        {
+            u32 n = 32 - m_tail_size;
+            if ((u64)n > size)
+                n = (u32)size;
+            x_memcopy(m_tail + m_tail_size, data, n);
+            m_tail_size += n;
+            data += n;
+            size -= n;
+            if (m_tail_size < 32)
+                return;
+            xchecksum::xxh64_stripes(m_lanes, m_tail, 1);
+            m_tail_size = 0;
+        }
+
+        u64 const stripes = size / 32;
+        xchecksum::xxh64_stripes(m_lanes, data, stripes);
+        data += stripes * 32;
+        size -= stripes * 32;
+
+        if (size > 0)
+        {
+            x_memcopy(m_tail, data, (u32)size);
+            m_tail_size = (u32)size;
+        }
+    }
+
+    u64 checksum_t::digest() const
+    {
+        if (m_algo == Checksum_CRC32C)
+            return (u64)(m_crc ^ 0xFFFFFFFF);
+
+        using namespace xchecksum;
+
+        u64 h;
+        if (m_total >= 32)
+        {
+            h = rotl64(m_lanes[0], 1) + rotl64(m_lanes[1], 7) + rotl64(m_lanes[2], 12) + rotl64(m_lanes[3], 18);
+            h = xxh64_merge(h, m_lanes[0]);
+            h = xxh64_merge(h, m_lanes[1]);
+            h = xxh64_merge(h, m_lanes[2]);
+            h = xxh64_merge(h, m_lanes[3]);
+        }
+        else
+        {
+            h = PRIME64_5;
+        }
+        h += m_total;
+
+        xbyte const* p    = m_tail;
+        u32          size = m_tail_size;
+        while (size >= 8)
+        {
+            h ^= xxh64_round(0, read64(p));
+            h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+            p += 8;
+            size -= 8;
+        }
+        if (size >= 4)
+        {
+            h ^= (u64)read32(p) * PRIME64_1;
+            h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+            p += 4;
+            size -= 4;
+        }
+        while (size > 0)
+        {
+            h ^= (u64)(*p) * PRIME64_5;
+            h = rotl64(h, 11) * PRIME64_1;
+            p += 1;
+            size -= 1;
+        }
+
+        h ^= h >> 33;
+        h *= PRIME64_2;
+        h ^= h >> 29;
+        h *= PRIME64_3;
+        h ^= h >> 32;
+        return h;
+    }
+
+}; // namespace xcore
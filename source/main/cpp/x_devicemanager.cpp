@@ -23,10 +23,27 @@ namespace xcore
 
         mNumAliases = 0;
         for (s32 i = 0; i < MAX_FILE_ALIASES; ++i)
-            mAliasList[i] = alias_t();
+            mAliasList[i].init(mContext->m_path_type);
         mNumDevices = 0;
-        for (s32 i = 0; i < MAX_FILE_ALIASES; ++i)
-            mDeviceList[i] = device_t();
+        for (s32 i = 0; i < MAX_FILE_DEVICES; ++i)
+            mDeviceList[i].init(mContext->m_path_type);
+        build_index();
+    }
+
+    void devicemanager_t::alias_t::init(s32 type)
+    {
+        mAlias       = path_t::make_runes(mAliasRunes, 0, ((s32)sizeof(mAliasRunes) / path_t::sizeof_rune(type)) - 1, type);
+        mAliasHash   = 0;
+        mTarget      = runes();
+        mResolved    = runes();
+        mDeviceIndex = -1;
+    }
+
+    void devicemanager_t::device_t::init(s32 type)
+    {
+        mDevName     = path_t::make_runes(mDevNameRunes, 0, ((s32)sizeof(mDevNameRunes) / path_t::sizeof_rune(type)) - 1, type);
+        mDevNameHash = 0;
+        mDevice      = nullptr;
     }
 
     void devicemanager_t::exit()
@@ -51,21 +68,79 @@ namespace xcore
         clear();
     }
 
-    static utf32::rune sDeviceSeperatorStr[] = {uchar32(':'), uchar32('\\'), uchar32(0)};
-    static crunes_t    sDeviceSeperator((utf32::pcrune)sDeviceSeperatorStr, (utf32::pcrune)(sDeviceSeperatorStr + 2));
+    static ascii::rune sDeviceSeperatorStr[] = {':', '\\', 0};
+    static crunes_t    sDeviceSeperator((ascii::pcrune)sDeviceSeperatorStr, (ascii::pcrune)(sDeviceSeperatorStr + 2));
+
+    // Device and alias names are case sensitive
+    static inline u64 hash_name(crunes_t const& name) { return path_t::hash(name, false); }
 
     //==============================================================================
     // Functions
     //==============================================================================
-    devicemanager_t::devicemanager_t(filesystem_t::context_t* ctxt) : mContext(ctxt), mNumAliases(0), mNumDevices(0) {}
+    devicemanager_t::devicemanager_t(filesystem_t::context_t* ctxt) : mNeedsResolve(false), mContext(ctxt), mNumAliases(0), mNumDevices(0)
+    {
+        for (s32 i = 0; i < MAX_FILE_ALIASES; ++i)
+            mAliasList[i].init(mContext->m_path_type);
+        for (s32 i = 0; i < MAX_FILE_DEVICES; ++i)
+            mDeviceList[i].init(mContext->m_path_type);
+        build_index();
+    }
+
+    //------------------------------------------------------------------------------
+    void devicemanager_t::build_index()
+    {
+        for (s32 i = 0; i < ALIAS_TABLE_SIZE; ++i)
+            mAliasTable[i] = -1;
+        for (s32 i = 0; i < mNumAliases; ++i)
+        {
+            u32 slot = (u32)mAliasList[i].mAliasHash & (ALIAS_TABLE_SIZE - 1);
+            while (mAliasTable[slot] >= 0)
+                slot = (slot + 1) & (ALIAS_TABLE_SIZE - 1);
+            mAliasTable[slot] = (s8)i;
+        }
+
+        for (s32 i = 0; i < DEVICE_TABLE_SIZE; ++i)
+            mDeviceTable[i] = -1;
+        for (s32 i = 0; i < mNumDevices; ++i)
+        {
+            u32 slot = (u32)mDeviceList[i].mDevNameHash & (DEVICE_TABLE_SIZE - 1);
+            while (mDeviceTable[slot] >= 0)
+                slot = (slot + 1) & (DEVICE_TABLE_SIZE - 1);
+            mDeviceTable[slot] = (s8)i;
+        }
+    }
+
+    // The tables are never full, so a probe always ends at a free entry
+    s32 devicemanager_t::lookup_alias(const crunes_t& name, u64 hash) const
+    {
+        for (u32 slot = (u32)hash & (ALIAS_TABLE_SIZE - 1); mAliasTable[slot] >= 0; slot = (slot + 1) & (ALIAS_TABLE_SIZE - 1))
+        {
+            alias_t const& alias = mAliasList[mAliasTable[slot]];
+            if (alias.mAliasHash == hash && compare(alias.mAlias, name) == 0)
+                return mAliasTable[slot];
+        }
+        return -1;
+    }
+
+    s32 devicemanager_t::lookup_device(const crunes_t& name, u64 hash) const
+    {
+        for (u32 slot = (u32)hash & (DEVICE_TABLE_SIZE - 1); mDeviceTable[slot] >= 0; slot = (slot + 1) & (DEVICE_TABLE_SIZE - 1))
+        {
+            device_t const& device = mDeviceList[mDeviceTable[slot]];
+            if (device.mDevNameHash == hash && compare(device.mDevName, name) == 0)
+                return mDeviceTable[slot];
+        }
+        return -1;
+    }
 
     //------------------------------------------------------------------------------
 
     bool devicemanager_t::add_device(const crunes_t& devicename, filedevice_t* device)
     {
+        u64 const hash = hash_name(devicename);
         for (s32 i = 0; i < mNumDevices; ++i)
         {
-            if (compare(mDeviceList[i].mDevName, devicename) == 0)
+            if (mDeviceList[i].mDevNameHash == hash && compare(mDeviceList[i].mDevName, devicename) == 0)
             {
                 mDeviceList[i].mDevice = device;
                 console->writeLine("INFO replaced file device for '%s'", va_list_t(va_t(devicename)));
@@ -77,6 +152,7 @@ namespace xcore
         if (mNumDevices < MAX_FILE_DEVICES)
         {
             copy(devicename, mDeviceList[mNumDevices].mDevName);
+            mDeviceList[mNumDevices].mDevNameHash = hash_name(mDeviceList[mNumDevices].mDevName);
             mDeviceList[mNumDevices].mDevice = device;
             mNumDevices++;
             mNeedsResolve = true;
@@ -96,9 +172,10 @@ namespace xcore
     // 'win_tempdir:\' => "c:\users\john\programs\mygame\temp\'
     bool devicemanager_t::add_alias(const crunes_t& alias, const crunes_t& target)
     {
+        u64 const hash = hash_name(alias);
         for (s32 i = 0; i < mNumAliases; ++i)
         {
-            if (compare(mAliasList[i].mAlias, alias) == 0)
+            if (mAliasList[i].mAliasHash == hash && compare(mAliasList[i].mAlias, alias) == 0)
             {
                 copy(target, mAliasList[i].mTarget, mContext->m_stralloc, 8);
                 console->writeLine("INFO replaced alias for '%s'", va_list_t(va_t(alias)));
@@ -110,6 +187,7 @@ namespace xcore
         if (mNumAliases < MAX_FILE_ALIASES)
         {
             copy(alias, mAliasList[mNumAliases].mAlias);
+            mAliasList[mNumAliases].mAliasHash = hash_name(mAliasList[mNumAliases].mAlias);
             copy(target, mAliasList[mNumAliases].mTarget, mContext->m_stralloc, 8);
             mNumAliases++;
             mNeedsResolve = true;
@@ -124,14 +202,14 @@ namespace xcore
 
     bool devicemanager_t::add_device(const char* devpath, filedevice_t* device)
     {
-        runez_t<utf32::rune, 32> devpath32(devpath);
-        return add_device(devpath32, device);
+        crunes_t devpathstr(devpath);
+        return add_device(devpathstr, device);
     }
 
     bool devicemanager_t::add_alias(const char* alias, const crunes_t& devname)
     {
-        runez_t<utf32::rune, 32> alias32(alias);
-        return add_alias(alias32, devname);
+        crunes_t aliasstr(alias);
+        return add_alias(aliasstr, devname);
     }
 
     void devicemanager_t::resolve()
@@ -181,6 +259,7 @@ namespace xcore
         };
 
         mNeedsResolve = false;
+        build_index();
 
         indexstack_t stack;
         for (s32 i = 0; i < mNumAliases; ++i)
@@ -238,16 +317,7 @@ namespace xcore
                 mAliasList[i].mDeviceIndex = -1;
                 runes_t resolved_devname   = findSelectUntilIncluded(resolved_path, sDeviceSeperator);
                 if (!resolved_devname.is_empty())
-                {
-                    for (s32 di = 0; di < mNumDevices; ++di)
-                    {
-                        if (compare(mDeviceList[di].mDevName, resolved_devname) == 0)
-                        {
-                            mAliasList[i].mDeviceIndex = di;
-                            break;
-                        }
-                    }
-                }
+                    mAliasList[i].mDeviceIndex = lookup_device(resolved_devname, hash_name(resolved_devname));
             }
         }
     }
@@ -256,27 +326,14 @@ namespace xcore
     {
         // reduce path to just the alias part
         crunes_t alias = findSelectUntilIncluded(path, sDeviceSeperator);
-        for (s32 i = 0; i < mNumAliases; ++i)
-        {
-            if (compare(mAliasList[i].mAlias, alias) == 0)
-            {
-                return i;
-            }
-        }
-        return -1;
+        return lookup_alias(alias, hash_name(alias));
     }
+
     s32 devicemanager_t::find_indexof_device(const crunes_t& path) const
     {
         // reduce path to just the device part
         crunes_t devname = findSelectUntilIncluded(path, sDeviceSeperator);
-        for (s32 i = 0; i < mNumDevices; ++i)
-        {
-            if (compare(mDeviceList[i].mDevName, devname) == 0)
-            {
-                return i;
-            }
-        }
-        return -1;
+        return lookup_device(devname, hash_name(devname));
     }
 
     //------------------------------------------------------------------------------
@@ -291,54 +348,87 @@ namespace xcore
         runes_t       devname = findSelectUntilIncluded(path.m_path, sDeviceSeperator);
         if (!devname.is_empty())
         {
-            for (s32 i = 0; i < mNumAliases; ++i)
-            {
-                if (compare(mAliasList[i].mAlias, devname) == 0)
-                {
-                    fd = mDeviceList[mAliasList[i].mDeviceIndex].mDevice;
-                    break;
-                }
-            }
+            u64 const hash  = hash_name(devname);
+            s32 const alias = lookup_alias(devname, hash);
+            s32 const index = (alias >= 0) ? mAliasList[alias].mDeviceIndex : lookup_device(devname, hash);
+            if (index >= 0)
+                fd = mDeviceList[index].mDevice;
         }
         return fd != nullptr;
     }
 
-    filedevice_t* devicemanager_t::find_device(const path_t& path, path_t& device_syspath)
+    filedevice_t* devicemanager_t::find_device(const path_t& path, crunes_t& prefix, crunes_t& relative)
     {
         if (mNeedsResolve)
         {
             resolve();
         }
 
-        filedevice_t* fd      = nullptr;
-        runes_t       devname = findSelectUntilIncluded(path.m_path, sDeviceSeperator);
-        if (!devname.is_empty())
+        runes_t devname = findSelectUntilIncluded(path.m_path, sDeviceSeperator);
+        if (devname.is_empty())
+            return nullptr;
+
+        // The path (filepath or dirpath) that the user provided follows the resolved path of the alias or the device
+        u64 const hash  = hash_name(devname);
+        s32 const alias = lookup_alias(devname, hash);
+        if (alias >= 0 && mAliasList[alias].mDeviceIndex >= 0)
         {
-            device_syspath = path_t(mContext);
-            for (s32 i = 0; i < mNumAliases; ++i)
-            {
-                if (compare(mAliasList[i].mAlias, devname) == 0)
-                {
-                    // Concatenate the path (filepath or dirpath) that the user provided to our resolved path
-                    runes_t relpath = selectAfterExclude(path.m_path, devname);
-                    concatenate(device_syspath.m_path, mAliasList[i].mResolved, relpath, device_syspath.m_context->m_stralloc, 16);
-                    if (mAliasList[i].mDeviceIndex >= 0)
-                    {
-                        return mDeviceList[mAliasList[i].mDeviceIndex].mDevice;
-                    }
-                }
-            }
-            for (s32 i = 0; i < mNumDevices; ++i)
-            {
-                if (compare(mDeviceList[i].mDevName, devname) == 0)
-                {
-                    // Concatenate the path (filepath or dirpath) that the user provided to our device path
-                    runes_t relpath = selectAfterExclude(path.m_path, devname);
-                    concatenate(device_syspath.m_path, mDeviceList[i].mDevName, relpath, mContext->m_stralloc, 16);
-                    return mDeviceList[i].mDevice;
-                }
-            }
+            prefix   = mAliasList[alias].mResolved;
+            relative = selectAfterExclude(path.m_path, devname);
+            return mDeviceList[mAliasList[alias].mDeviceIndex].mDevice;
         }
+        s32 const device = lookup_device(devname, hash);
+        if (device >= 0)
+        {
+            prefix   = mDeviceList[device].mDevName;
+            relative = selectAfterExclude(path.m_path, devname);
+            return mDeviceList[device].mDevice;
+        }
+        return nullptr;
+    }
+
+    // Number of runes between str and end, the runes are of the encoding of the paths
+    static s32 rune_count(void const* str, void const* end, s32 type) { return (s32)(((xbyte const*)end - (xbyte const*)str) / path_t::sizeof_rune(type)); }
+
+    filedevice_t* devicemanager_t::find_device(const path_t& path, runes_t& syspath)
+    {
+        ASSERT(syspath.m_type == mContext->m_path_type);
+
+        crunes_t      prefix, relative;
+        filedevice_t* fd = find_device(path, prefix, relative);
+        if (fd == nullptr)
+            return nullptr;
+
+        s32 const type = mContext->m_path_type;
+        s32 const len  = rune_count(prefix.m_runes.m_ascii.m_str, prefix.m_runes.m_ascii.m_end, type) + rune_count(relative.m_runes.m_ascii.m_str, relative.m_runes.m_ascii.m_end, type);
+        if (len > rune_count(syspath.m_runes.m_ascii.m_str, syspath.m_runes.m_ascii.m_eos, type))
+            return nullptr;
+
+        copy(prefix, syspath);
+        concatenate(syspath, relative);
         return fd;
     }
+
+    filedevice_t* devicemanager_t::find_device(const path_t& path, path_t& device_syspath)
+    {
+        crunes_t      prefix, relative;
+        filedevice_t* fd = find_device(path, prefix, relative);
+        if (fd == nullptr)
+            return nullptr;
+
+        // Keep the runes of @device_syspath when it already belongs to this filesystem
+        if (device_syspath.m_context == mContext)
+            device_syspath.clear();
+        else
+            device_syspath = path_t(mContext);
+        concatenate(device_syspath.m_path, prefix, relative, device_syspath.alloc(), 16);
+        return fd;
+    }
+
+    filedevice_t* devicemanager_t::find_device(const crunes_t& path, path_t& device_syspath)
+    {
+        // A short path is stored inline, normalizing it does not allocate
+        path_t normalized(mContext, path);
+        return find_device(normalized, device_syspath);
+    }
 }; // namespace xcore
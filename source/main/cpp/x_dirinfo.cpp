@@ -17,6 +17,7 @@ namespace xcore
 {
     dirinfo_t::dirinfo_t() {}
     dirinfo_t::dirinfo_t(const dirinfo_t& dirinfo) : m_path(dirinfo.m_path) {}
+    dirinfo_t::dirinfo_t(dirinfo_t&& dirinfo) : m_path(static_cast<dirpath_t&&>(dirinfo.m_path)) {}
     dirinfo_t::dirinfo_t(const dirpath_t& dir) : m_path(dir) {}
 
     bool             dirinfo_t::isRoot() const { return m_path.isRoot(); }
@@ -45,6 +46,15 @@ namespace xcore
         return *this;
     }
 
+    dirinfo_t& dirinfo_t::operator=(dirinfo_t&& other)
+    {
+        if (this == &other)
+            return *this;
+
+        m_path = static_cast<dirpath_t&&>(other.m_path);
+        return *this;
+    }
+
     dirinfo_t& dirinfo_t::operator=(const dirpath_t& other)
     {
         if (&m_path == &other)
@@ -15,14 +15,16 @@ namespace xcore
     {
     }
 
-    dirpath_t::dirpath_t(filesystem_t::context_t* ctxt, crunes_t const& path) : m_context(ctxt)
-    {
-        m_path.m_context= ctxt;
-        copy(path, m_path.m_path, ctxt->m_stralloc);
-    }
+    dirpath_t::dirpath_t(filesystem_t::context_t* ctxt, crunes_t const& path) : m_context(ctxt), m_path(ctxt, path) {}
 
     dirpath_t::dirpath_t() : m_context(nullptr), m_path() {}
     dirpath_t::dirpath_t(const dirpath_t& dirpath) : m_context(dirpath.m_context), m_path(dirpath.m_path) {}
+    dirpath_t::dirpath_t(dirpath_t&& dirpath) : m_context(dirpath.m_context), m_path(static_cast<path_t&&>(dirpath.m_path)) {}
+    dirpath_t::dirpath_t(u32 pathid) : m_context(nullptr), m_path()
+    {
+        filesys_t::interned_path(pathid, m_path);
+        m_context = m_path.m_context;
+    }
     dirpath_t::dirpath_t(const dirpath_t& rootdir, const dirpath_t& subpath) : m_context(rootdir.m_context), m_path(rootdir.m_path, subpath.m_path) {}
 
     dirpath_t::~dirpath_t() {}
@@ -74,9 +76,8 @@ namespace xcore
 
     dirpath_t& dirpath_t::operator=(const filepath_t& fp)
     {
-        // Copy the runes
-        path_t const& path = filesys_t::get_path(fp);
-        copy(path.m_path, m_path.m_path, m_path.m_context->m_stralloc, 16);
+        // Copy the runes, path_t::operator= also invalidates the level index and the hash
+        m_path = filesys_t::get_path(fp);
         return *this;
     }
 
@@ -85,13 +86,25 @@ namespace xcore
         if (this == &dp)
             return *this;
 
-        // Copy the runes
-        path_t const& path = filesys_t::get_path(dp);
-        copy(path.m_path, m_path.m_path, m_path.m_context->m_stralloc, 16);
+        // Copy the runes, path_t::operator= also invalidates the level index and the hash
+        m_path = filesys_t::get_path(dp);
+
+        return *this;
+    }
+
+    dirpath_t& dirpath_t::operator=(dirpath_t&& dp)
+    {
+        if (this == &dp)
+            return *this;
 
+        m_context = dp.m_context;
+        m_path    = static_cast<path_t&&>(dp.m_path);
         return *this;
     }
 
+    u64 dirpath_t::hash() const { return m_path.hash(); }
+    u64 dirpath_t::hash_folded() const { return m_path.hash_folded(); }
+
     bool dirpath_t::operator==(const dirpath_t& rhs) const { return rhs.m_path == m_path; }
     bool dirpath_t::operator!=(const dirpath_t& rhs) const { return rhs.m_path != m_path; }
 
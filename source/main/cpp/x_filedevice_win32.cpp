@@ -40,11 +40,12 @@ namespace xcore
 
         XCORE_CLASS_PLACEMENT_NEW_DELETE
 
-        filedevice_pc_t(alloc_t* alloc, const dirpath_t& pDrivePath, bool boCanWrite) : mAllocator(alloc), mDrivePath(pDrivePath), mCanWrite(boCanWrite) {}
+        filedevice_pc_t(alloc_t* alloc, const dirpath_t& pDrivePath, bool boCanWrite) : mAllocator(alloc), mDrivePath(pDrivePath), mCanWrite(boCanWrite) { filesys_t::get_path(mDrivePath).set_persistent(); }
         virtual ~filedevice_pc_t() {}
 
         virtual bool canSeek() const { return true; }
         virtual bool canWrite() const { return mCanWrite; }
+        virtual bool isCaseSensitive() const { return false; }
 
         virtual bool getDeviceInfo(u64& totalSpace, u64& freeSpace) const;
 
@@ -59,6 +60,7 @@ namespace xcore
 
         virtual bool setLengthOfFile(void* nFileHandle, u64 inLength);
         virtual bool getLengthOfFile(void* nFileHandle, u64& outLength);
+        virtual bool getLengthOfFileByPath(const filepath_t& szFilename, u64& outLength);
 
         virtual bool setFileTime(const filepath_t& szFilename, const filetimes_t& ftimes);
         virtual bool getFileTime(const filepath_t& szFilename, filetimes_t& ftimes);
@@ -343,6 +345,18 @@ namespace xcore
         return true;
     }
 
+    bool filedevice_pc_t::getLengthOfFileByPath(const filepath_t& szFilename, u64& outLength)
+    {
+        path_t filename16;
+        path_t::as_utf16(szFilename, filename16);
+
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (::GetFileAttributesExW(LPCWSTR(filename16.m_path.m_runes.m_utf16.m_str), GetFileExInfoStandard, &data) == FALSE)
+            return false;
+        outLength = xmem::makeu64(data.nFileSizeLow, data.nFileSizeHigh);
+        return true;
+    }
+
     bool filedevice_pc_t::setFileTime(const filepath_t& szFilename, const filetimes_t& ftimes)
     {
         void* nFileHandle;
@@ -589,7 +603,7 @@ namespace xcore
         {
             xnode* nextnode = mNodeHeap->construct<xdirwalker::xnode>();
 
-            concatenate(mDirPath.m_path, mWildcard, mDirPath.m_context->m_stralloc, 16);
+            concatenate(mDirPath.m_path, mWildcard, mDirPath.alloc(), 16);
             path_t dirpath16;
             path_t::as_utf16(mDirPath, dirpath16);
             nextnode->mFindHandle = ::FindFirstFileW(LPCWSTR(dirpath16.m_path.m_runes.m_utf16.m_str), &nextnode->mFindData);
@@ -626,13 +640,13 @@ namespace xcore
             {
                 dirname.m_path.m_runes.m_utf16.m_end++;
             }
-            concatenate(mDirPath.m_path, dirname.m_path, mDirPath.m_context->m_stralloc, 4);
+            concatenate(mDirPath.m_path, dirname.m_path, mDirPath.alloc(), 4);
 
             runez_t<utf32::rune, 4> slash;
             *slash.m_runes.m_utf16.m_end++ = '\\';
             *slash.m_runes.m_utf16.m_end   = '\0';
 
-            concatenate(mDirPath.m_path, slash, mDirPath.m_context->m_stralloc, 16);
+            concatenate(mDirPath.m_path, slash, mDirPath.alloc(), 16);
 
             // We have found a directory, enter
             if (!enter_dir())
@@ -666,7 +680,7 @@ namespace xcore
                 filename.m_runes.m_utf16.m_end++;
             }
             mFilePath.copy_dirpath(mDirPath.m_path);
-            concatenate(mFilePath.m_path, filename, mFilePath.m_context->m_stralloc, 4);
+            concatenate(mFilePath.m_path, filename, mFilePath.alloc(), 4);
 
             return (enumerator(mLevel, &mFileInfo, nullptr));
         }
@@ -10,6 +10,7 @@
 #include "xfilesystem/x_fileinfo.h"
 #include "xfilesystem/x_stream.h"
 #include "xfilesystem/x_filesystem.h"
+#include "xfilesystem/private/x_checksum.h"
 #include "xfilesystem/private/x_filedevice.h"
 #include "xfilesystem/private/x_filesystem.h"
 #include "xfilesystem/private/x_istream.h"
@@ -19,6 +20,7 @@ namespace xcore
 {
     fileinfo_t::fileinfo_t() : mFileExists(false), mFileTimes(), mFileAttributes(), m_context(nullptr), m_path() {}
     fileinfo_t::fileinfo_t(const fileinfo_t& fi) : mFileExists(fi.mFileExists), mFileTimes(fi.mFileTimes), mFileAttributes(fi.mFileAttributes), m_context(fi.m_context), m_path(fi.m_path) {}
+    fileinfo_t::fileinfo_t(fileinfo_t&& fi) : mFileExists(fi.mFileExists), mFileTimes(fi.mFileTimes), mFileAttributes(fi.mFileAttributes), m_context(fi.m_context), m_path(static_cast<filepath_t&&>(fi.m_path)) {}
     fileinfo_t::fileinfo_t(const filepath_t& fp) : m_context(fp.m_context), m_path(fp) {}
 
     u64  fileinfo_t::getLength() const { return sGetLength(m_path); }
@@ -153,6 +155,15 @@ namespace xcore
         return *this;
     }
 
+    fileinfo_t& fileinfo_t::operator=(fileinfo_t&& other)
+    {
+        if (this == &other)
+            return *this;
+
+        m_path = static_cast<filepath_t&&>(other.m_path);
+        return *this;
+    }
+
     fileinfo_t& fileinfo_t::operator=(const filepath_t& other)
     {
         if (&m_path == &other)
@@ -383,6 +394,34 @@ namespace xcore
         return false;
     }
 
+    u64 fileinfo_t::sChecksum(const filepath_t& filepath, EChecksum algo)
+    {
+        alloc_t* allocator = filesys_t::get_filesystem(filepath)->m_context.m_allocator;
+        xbyte*   data      = (xbyte*)allocator->allocate(64 * 1024, FS_MEM_ALIGNMENT);
+        buffer_t buffer(64 * 1024, data);
+        u64 const digest = sChecksum(filepath, algo, buffer);
+        allocator->deallocate(data);
+        return digest;
+    }
+
+    u64 fileinfo_t::sChecksum(const filepath_t& filepath, EChecksum algo, buffer_t& buffer)
+    {
+        checksum_t checksum(algo);
+        stream_t   stream = filesys_t::create_filestream(filepath, FileMode_Open, FileAccess_Read, FileOp_Sync);
+        if (stream.isOpen())
+        {
+            s64 n = stream.read(buffer.m_mutable, (s64)buffer.m_len);
+            while (n > 0)
+            {
+                checksum.update(buffer.m_mutable, (u64)n);
+                n = stream.read(buffer.m_mutable, (s64)buffer.m_len);
+            }
+            stream.close();
+        }
+        filesys_t::destroy(stream);
+        return checksum.digest();
+    }
+
     bool fileinfo_t::sCopy(const filepath_t& srcfilepath, const filepath_t& dstfilepath, bool overwrite)
     {
         filedevice_t* srcdevice;
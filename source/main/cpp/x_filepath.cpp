@@ -3,6 +3,7 @@
 #include "xbase/x_runes.h"
 
 #include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filesystem.h"
 #include "xfilesystem/private/x_path.h"
 #include "xfilesystem/x_dirpath.h"
 #include "xfilesystem/x_filepath.h"
@@ -13,13 +14,15 @@ namespace xcore
     filepath_t::filepath_t(filesystem_t::context_t* ctxt) : m_context(ctxt), m_path(ctxt)
     {
     }
-    filepath_t::filepath_t(filesystem_t::context_t* ctxt, crunes_t const& path) : m_context(ctxt), m_path()
-    {
-        m_path.m_context = ctxt;
-        copy(path, m_path.m_path, ctxt->m_stralloc);
-    }
+    filepath_t::filepath_t(filesystem_t::context_t* ctxt, crunes_t const& path) : m_context(ctxt), m_path(ctxt, path) {}
 
     filepath_t::filepath_t(const filepath_t& filepath) : m_context(filepath.m_context), m_path() { m_path = filepath.m_path; }
+    filepath_t::filepath_t(filepath_t&& filepath) : m_context(filepath.m_context), m_path(static_cast<path_t&&>(filepath.m_path)) {}
+    filepath_t::filepath_t(u32 pathid) : m_context(nullptr), m_path()
+    {
+        filesys_t::interned_path(pathid, m_path);
+        m_context = m_path.m_context;
+    }
     filepath_t::filepath_t(const dirpath_t& dirpath, const filepath_t& filepath) : m_context(filepath.m_context), m_path() { m_path.combine(dirpath.m_path, filepath.m_path); }
     filepath_t::~filepath_t() {}
 
@@ -52,6 +55,18 @@ namespace xcore
         return *this;
     }
 
+    filepath_t& filepath_t::operator=(filepath_t&& path)
+    {
+        if (this == &path)
+            return *this;
+        m_context = path.m_context;
+        m_path    = static_cast<path_t&&>(path.m_path);
+        return *this;
+    }
+
+    u64 filepath_t::hash() const { return m_path.hash(); }
+    u64 filepath_t::hash_folded() const { return m_path.hash_folded(); }
+
     bool filepath_t::operator==(const filepath_t& rhs) const { return m_path == rhs.m_path; }
     bool filepath_t::operator!=(const filepath_t& rhs) const { return m_path != rhs.m_path; }
 
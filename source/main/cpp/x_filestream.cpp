@@ -8,9 +8,11 @@
 #include "xfilesystem/x_filepath.h"
 #include "xfilesystem/x_stream.h"
 
+#include "xfilesystem/private/x_atomic.h"
 #include "xfilesystem/private/x_enumerations.h"
 #include "xfilesystem/private/x_filedevice.h"
 #include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_ioqueue.h"
 #include "xfilesystem/private/x_istream.h"
 
 namespace xcore
@@ -22,24 +24,11 @@ namespace xcore
         virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length);
         virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos);
         virtual void close(filedevice_t* fd, filehandle_t*& fh);
+        virtual void flush(filedevice_t* fd, filehandle_t* fh);
         virtual s64 read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count);
         virtual s64 write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count);
     };
 
-    enum ECaps
-    {
-        NONE      = 0x0000,
-        CAN_READ  = 0x0001,
-        CAN_SEEK  = 0x0002,
-        CAN_WRITE = 0x0004,
-        CAN_ASYNC = 0x0008,
-        USE_READ  = 0x1000,
-        USE_SEEK  = 0x2000,
-        USE_WRITE = 0x4000,
-        USE_ASYNC = 0x8000,
-    };
-
-    //extern istream_t* get_filestream();
     static filestream_t s_filestream;
     istream_t* get_filestream()
     {
@@ -48,7 +37,7 @@ namespace xcore
 
     // ---------------------------------------------------------------------------------------------
 
-    void* open_filestream(filedevice_t* fd, const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op, u32 out_caps)
+    u32 filestream_caps(filedevice_t* fd, EFileAccess access, EFileOp op)
     {
         bool can_read, can_write, can_seek, can_async;
         
@@ -69,6 +58,20 @@ namespace xcore
         caps.test_set(USE_WRITE, can_write && ((access & FileAccess_Write) != 0));
         caps.test_set(USE_ASYNC, can_async && (op == FileOp_Async));
 
+        static const ECaps sAllCaps[] = {CAN_READ, CAN_SEEK, CAN_WRITE, CAN_ASYNC, USE_READ, USE_SEEK, USE_WRITE, USE_ASYNC};
+        u32 out_caps = NONE;
+        for (s32 i = 0; i < (s32)(sizeof(sAllCaps) / sizeof(sAllCaps[0])); ++i)
+        {
+            if (caps.is_set(sAllCaps[i]))
+                out_caps |= sAllCaps[i];
+        }
+        return out_caps;
+    }
+
+    void* open_filestream(filedevice_t* fd, const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op, u32& out_caps)
+    {
+        enum_t<ECaps> caps(filestream_caps(fd, access, op));
+
         void* handle = nullptr;
         switch (mode)
         {
@@ -163,18 +166,37 @@ namespace xcore
         break;
         }
 
+        static const ECaps sAllCaps[] = {CAN_READ, CAN_SEEK, CAN_WRITE, CAN_ASYNC, USE_READ, USE_SEEK, USE_WRITE, USE_ASYNC};
+        out_caps = NONE;
+        for (s32 i = 0; i < (s32)(sizeof(sAllCaps) / sizeof(sAllCaps[0])); ++i)
+        {
+            if (caps.is_set(sAllCaps[i]))
+                out_caps |= sAllCaps[i];
+        }
         return handle;
     }
 
     u64  filestream_t::getLength(filedevice_t* fd, filehandle_t* fh)
     {
-        u64 length;
-        if (fd->getLengthOfFile(fh, length))
+        // A file that was opened lazily or whose OS handle was closed is not opened just to get its length
+        u64 length = 0;
+        if (fh->m_owner->get_length_without_oshandle(fd, fh, length))
             return length;
-        return 0;
+
+        void* handle = fh->m_owner->acquire_oshandle(fd, fh);
+        if (handle == INVALID_FILE_HANDLE || !fd->getLengthOfFile(handle, length))
+            length = 0;
+        fh->m_owner->release_oshandle(fh);
+        return length;
     }
 
-    void filestream_t::setLength(filedevice_t* fd, filehandle_t* fh, u64 length) { fd->setLengthOfFile(fh, length); }
+    void filestream_t::setLength(filedevice_t* fd, filehandle_t* fh, u64 length)
+    {
+        void* handle = fh->m_owner->acquire_oshandle(fd, fh);
+        if (handle != INVALID_FILE_HANDLE)
+            fd->setLengthOfFile(handle, length);
+        fh->m_owner->release_oshandle(fh);
+    }
 
     s64 filestream_t::setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& offset, s64 seek)
     {
@@ -189,22 +211,27 @@ namespace xcore
 
     void filestream_t::close(filedevice_t* fd, filehandle_t*& fh)
     {
-        if (fh != INVALID_FILE_HANDLE)
+        void* handle = fh->m_owner->detach_oshandle(fh);
+        if (handle != INVALID_FILE_HANDLE)
         {
-            fd->closeFile(fh);
+            fd->closeFile(handle);
         }
     }
 
+    void filestream_t::flush(filedevice_t* fd, filehandle_t* fh) {}
+
     s64 filestream_t::read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count)
     {
         enum_t<ECaps> ecaps(caps);
         if (ecaps.is_set(USE_READ))
         {
-            u64 n;
-            if (fd->readFile(fh, pos, buffer, count, n))
+            u64   n      = 0;
+            void* handle = fh->m_owner->acquire_oshandle(fd, fh);
+            if (handle != INVALID_FILE_HANDLE && fd->readFile(handle, pos, buffer, count, n))
             {
                 pos += n;
             }
+            fh->m_owner->release_oshandle(fh);
             return n;
         }
         return 0;
@@ -215,31 +242,156 @@ namespace xcore
         enum_t<ECaps> ecaps(caps);
         if (ecaps.is_set(USE_WRITE))
         {
-            u64 n;
-            if (fd->writeFile(fh, pos, buffer, count, n))
+            u64   n      = 0;
+            void* handle = fh->m_owner->acquire_oshandle(fd, fh);
+            if (handle != INVALID_FILE_HANDLE && fd->writeFile(handle, pos, buffer, count, n))
             {
                 pos += n;
             }
+            fh->m_owner->release_oshandle(fh);
             return n;
         }
         return 0;
     }
 
 
-    void xstream_copy(stream_t& src, stream_t& dst, buffer_t& buffer)
+    // ---------------------------------------------------------------------------------------------
+    // Stream copy, the write of one block is handed to the IO thread while the next block is read
+
+    class copyjob_t : public iojob_t
+    {
+    public:
+        enum EState
+        {
+            STATE_FREE    = 0,
+            STATE_PENDING = 1,
+        };
+
+        inline copyjob_t() : m_dst(nullptr), m_data(nullptr), m_size(0), m_written(0), m_state(STATE_FREE) {}
+
+        virtual void execute()
+        {
+            m_written = m_dst->write(m_data, m_size);
+            xatomic::store(&m_state, STATE_FREE);
+        }
+
+        // Waits until the write is done, when the IO thread did not pick it up yet it is executed here
+        void wait(ioqueue_t* queue)
+        {
+            if (xatomic::load(&m_state) == STATE_PENDING && (queue == nullptr || queue->remove(this)))
+            {
+                execute();
+            }
+            while (xatomic::load(&m_state) == STATE_PENDING)
+            {
+                xatomic::pause();
+            }
+        }
+
+        stream_t*    m_dst;
+        xbyte const* m_data;
+        s64          m_size;
+        s64          m_written;
+        s32 volatile m_state;
+    };
+
+    u64 filesys_t::copy_stream(stream_t& src, stream_t& dst, u64 count, buffer_t& buffer, copy_progress_t* progress)
     {
-        reader_t* reader = src.get_reader();
-        writer_t* writer = dst.get_writer();
-        s64 streamLength = (s64)src.getLength();
-        while (streamLength > 0)
+        if (!src.isOpen() || !dst.isOpen())
+            return 0;
+
+        u64 const available = src.getLength() - (u64)src.getPos();
+        if (count > available)
+            count = available;
+        if (count == 0)
+            return 0;
+
+        // Let the device copy when the data does not need to pass through any stream layer, streams of which the
+        // OS handle cannot be opened again fall back to reading and writing
+        if (src.m_filedevice == dst.m_filedevice && src.m_pimpl == get_filestream() && dst.m_pimpl == get_filestream())
+        {
+            u64        copied     = 0;
+            filesys_t* fs         = src.m_filehandle->m_owner;
+            void*      src_handle = fs->acquire_oshandle(src.m_filedevice, src.m_filehandle);
+            void*      dst_handle = fs->acquire_oshandle(dst.m_filedevice, dst.m_filehandle);
+            bool const valid      = src_handle != INVALID_FILE_HANDLE && dst_handle != INVALID_FILE_HANDLE;
+            bool const done       = valid && src.m_filedevice->copyFileRange(src_handle, (u64)src.m_offset, dst_handle, (u64)dst.m_offset, count, copied);
+            fs->release_oshandle(dst.m_filehandle);
+            fs->release_oshandle(src.m_filehandle);
+            if (done)
+            {
+                src.m_offset += copied;
+                dst.m_offset += copied;
+                dst.m_length = -1;
+                if (progress != nullptr)
+                    progress->progress(copied, count);
+                return copied;
+            }
+        }
+
+        // Two halves of the buffer, one is being written while the other is being read.
+        // Only streams on different file handles are written by the IO thread.
+        s64 const  block_size = (s64)(buffer.m_len / 2);
+        xbyte*     blocks[2]  = {buffer.m_mutable, buffer.m_mutable + block_size};
+        ioqueue_t* queue      = nullptr;
+        if (src.m_filehandle != dst.m_filehandle && src.m_filehandle->m_handle != dst.m_filehandle->m_handle)
+            queue = src.m_filehandle->m_owner->m_ioqueue;
+        if (block_size == 0)
+            return 0;
+
+        copyjob_t job;
+        job.m_dst = &dst;
+
+        u64 copied    = 0;
+        u64 remaining = count;
+        s32 current   = 0;
+        while (remaining > 0)
         {
-            u64 const r = reader->read(buffer.m_mutable, buffer.m_len);
-            writer->write(buffer.m_mutable, buffer.m_len);
-            streamLength -= r;
+            s64 const n = src.read(blocks[current], (remaining < (u64)block_size) ? (s64)remaining : block_size);
+            if (n <= 0)
+                break;
+
+            // The previous block has to be written before the next write is issued
+            job.wait(queue);
+            if (job.m_written != job.m_size)
+                break;
+            copied += (u64)job.m_written;
+            if (job.m_size > 0 && progress != nullptr)
+                progress->progress(copied, count);
+
+            job.m_data    = blocks[current];
+            job.m_size    = n;
+            job.m_written = 0;
+            xatomic::store(&job.m_state, copyjob_t::STATE_PENDING);
+            if (queue != nullptr)
+                queue->push(&job);
+
+            remaining -= (u64)n;
+            current ^= 1;
         }
+
+        job.wait(queue);
+        copied += (u64)job.m_written;
+        if (job.m_size > 0 && progress != nullptr)
+            progress->progress(copied, count);
+        return copied;
     }
 
-    void xstream_copy(stream_t& src, stream_t& dst, u64 count) {}
+    void xstream_copy(stream_t& src, stream_t& dst, buffer_t& buffer) { filesys_t::copy_stream(src, dst, X_U64_MAX, buffer, nullptr); }
+
+    u64 xstream_copy(stream_t& src, stream_t& dst, u64 count, buffer_t& buffer, copy_progress_t* progress) { return filesys_t::copy_stream(src, dst, count, buffer, progress); }
 
+    u64 xstream_copy(stream_t& src, stream_t& dst, u64 count, copy_progress_t* progress)
+    {
+        if (!src.isOpen())
+            return 0;
+
+        alloc_t* allocator = filesys_t::get_allocator(src);
+        xbyte*   data      = (xbyte*)allocator->allocate(2 * 64 * 1024, FS_MEM_ALIGNMENT);
+        buffer_t buffer(2 * 64 * 1024, data);
+        u64 const copied = filesys_t::copy_stream(src, dst, count, buffer, progress);
+        allocator->deallocate(data);
+        return copied;
+    }
 
 }; // namespace xcore
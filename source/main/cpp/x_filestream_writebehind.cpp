@@ -0,0 +1,303 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+
+#include "xfilesystem/private/x_atomic.h"
+#include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filedevice.h"
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_ioqueue.h"
+#include "xfilesystem/private/x_istream.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // writebehind_stream_t:
+    //     Coalesces (small) sequential writes into a fixed set of buffers. A full
+    //     buffer is handed to the IO thread and the user continues writing into
+    //     the next free buffer. When all buffers are in flight the user thread
+    //     takes a pending buffer back from the IO queue and writes it itself, so
+    //     this also works when there is no IO thread running.
+    //
+    //     flush() is a barrier, when it returns all data written so far has been
+    //     handed to the file device.
+    //==============================================================================
+    class writebehind_stream_t : public istream_t
+    {
+    public:
+        enum EState
+        {
+            STATE_FREE    = 0,
+            STATE_FILLING = 1,
+            STATE_PENDING = 2,
+        };
+
+        class block_t : public iojob_t
+        {
+        public:
+            inline block_t() : m_owner(nullptr), m_data(nullptr), m_size(0), m_pos(0), m_state(STATE_FREE) {}
+
+            virtual void execute() { m_owner->write_block(this); }
+
+            writebehind_stream_t* m_owner;
+            xbyte*                m_data;
+            u32                   m_size;
+            s64                   m_pos;
+            s32 volatile          m_state;
+        };
+
+        writebehind_stream_t(alloc_t* allocator, ioqueue_t* queue, u32 buffer_size, u32 buffer_count);
+        ~writebehind_stream_t();
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        virtual u64  getLength(filedevice_t* fd, filehandle_t* fh);
+        virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length);
+        virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos);
+        virtual void close(filedevice_t* fd, filehandle_t*& fh);
+        virtual void flush(filedevice_t* fd, filehandle_t* fh);
+        virtual s64  read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count);
+        virtual s64  write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count);
+
+        void write_block(block_t* block);
+
+    protected:
+        block_t* acquire_block(s64 pos);
+        void     submit_block(block_t* block);
+
+        alloc_t*      m_allocator;
+        ioqueue_t*    m_queue;
+        filedevice_t* m_fd;
+        filehandle_t* m_fh;
+        u32           m_buffer_size;
+        u32           m_buffer_count;
+        xbyte*        m_buffer_data;
+        block_t*      m_blocks;
+        block_t*      m_current;
+        s64           m_end_pos;
+        s32 volatile  m_error;
+    };
+
+    writebehind_stream_t::writebehind_stream_t(alloc_t* allocator, ioqueue_t* queue, u32 buffer_size, u32 buffer_count)
+        : istream_t(1)
+        , m_allocator(allocator)
+        , m_queue(queue)
+        , m_fd(nullptr)
+        , m_fh(nullptr)
+        , m_buffer_size(buffer_size)
+        , m_buffer_count(buffer_count)
+        , m_buffer_data(nullptr)
+        , m_blocks(nullptr)
+        , m_current(nullptr)
+        , m_end_pos(-1)
+        , m_error(0)
+    {
+        m_buffer_data = (xbyte*)m_allocator->allocate(m_buffer_size * m_buffer_count, FS_MEM_ALIGNMENT);
+        m_blocks      = (block_t*)m_allocator->allocate(sizeof(block_t) * m_buffer_count, sizeof(void*));
+        for (u32 i = 0; i < m_buffer_count; ++i)
+        {
+            block_t* block = new (&m_blocks[i]) block_t();
+            block->m_owner = this;
+            block->m_data  = m_buffer_data + (i * m_buffer_size);
+        }
+    }
+
+    writebehind_stream_t::~writebehind_stream_t()
+    {
+        for (u32 i = 0; i < m_buffer_count; ++i)
+        {
+            m_blocks[i].~block_t();
+        }
+        m_allocator->deallocate(m_blocks);
+        m_allocator->deallocate(m_buffer_data);
+    }
+
+    u64 writebehind_stream_t::getLength(filedevice_t* fd, filehandle_t* fh)
+    {
+        flush(fd, fh);
+        return get_filestream()->getLength(fd, fh);
+    }
+
+    void writebehind_stream_t::setLength(filedevice_t* fd, filehandle_t* fh, u64 length)
+    {
+        flush(fd, fh);
+        get_filestream()->setLength(fd, fh, length);
+    }
+
+    s64 writebehind_stream_t::setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos) { return get_filestream()->setPos(fd, fh, caps, current, pos); }
+
+    void writebehind_stream_t::close(filedevice_t* fd, filehandle_t*& fh)
+    {
+        flush(fd, fh);
+        filesys_t::release_stream(get_filestream(), fd, fh);
+
+        alloc_t* allocator = m_allocator;
+        allocator->destruct(this);
+    }
+
+    void writebehind_stream_t::flush(filedevice_t* fd, filehandle_t* fh)
+    {
+        // The partially filled buffer is written on the calling thread
+        if (m_current != nullptr)
+        {
+            block_t* block = m_current;
+            m_current      = nullptr;
+            if (block->m_size > 0)
+            {
+                xatomic::store(&block->m_state, STATE_PENDING);
+                write_block(block);
+            }
+            else
+            {
+                xatomic::store(&block->m_state, STATE_FREE);
+            }
+        }
+
+        // Take back any buffer that the IO thread did not pick up yet
+        for (u32 i = 0; i < m_buffer_count; ++i)
+        {
+            block_t* block = &m_blocks[i];
+            if (xatomic::load(&block->m_state) == STATE_PENDING && m_queue->remove(block))
+            {
+                write_block(block);
+            }
+        }
+
+        // Wait for the buffers that the IO thread is writing at this moment
+        for (u32 i = 0; i < m_buffer_count; ++i)
+        {
+            block_t* block = &m_blocks[i];
+            while (xatomic::load(&block->m_state) == STATE_PENDING)
+            {
+                xatomic::pause();
+            }
+        }
+    }
+
+    s64 writebehind_stream_t::read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count)
+    {
+        // Reading has to observe everything that has been written before
+        flush(fd, fh);
+        return get_filestream()->read(fd, fh, caps, pos, buffer, count);
+    }
+
+    s64 writebehind_stream_t::write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count)
+    {
+        if ((caps & USE_WRITE) == 0 || xatomic::load(&m_error) != 0)
+            return 0;
+
+        // A write that does not continue where the previous write ended could
+        // overlap with a buffer that is still in flight.
+        if (pos != m_end_pos)
+        {
+            flush(fd, fh);
+        }
+
+        m_fd = fd;
+        m_fh = fh;
+
+        s64 written = 0;
+        while (written < count)
+        {
+            s64 const remaining = count - written;
+            if (m_current == nullptr)
+            {
+                if (remaining >= (s64)m_buffer_size)
+                {
+                    // Large writes do not benefit from coalescing, write them directly
+                    u64        n      = 0;
+                    void*      handle = fh->m_owner->acquire_oshandle(fd, fh);
+                    bool const ok     = handle != INVALID_FILE_HANDLE && fd->writeFile(handle, pos, buffer + written, remaining, n);
+                    fh->m_owner->release_oshandle(fh);
+                    if (!ok)
+                    {
+                        xatomic::store(&m_error, 1);
+                        break;
+                    }
+                    pos += n;
+                    written += n;
+                    break;
+                }
+                m_current = acquire_block(pos);
+            }
+
+            u32 const space = m_buffer_size - m_current->m_size;
+            u32 const n     = (remaining < (s64)space) ? (u32)remaining : space;
+            x_memcopy(m_current->m_data + m_current->m_size, buffer + written, n);
+            m_current->m_size += n;
+            written += n;
+            pos += n;
+
+            if (m_current->m_size == m_buffer_size)
+            {
+                submit_block(m_current);
+                m_current = nullptr;
+            }
+        }
+
+        m_end_pos = pos;
+        return written;
+    }
+
+    void writebehind_stream_t::write_block(block_t* block)
+    {
+        u64        n      = 0;
+        void*      handle = m_fh->m_owner->acquire_oshandle(m_fd, m_fh);
+        bool const ok     = handle != INVALID_FILE_HANDLE && m_fd->writeFile(handle, block->m_pos, block->m_data, block->m_size, n);
+        m_fh->m_owner->release_oshandle(m_fh);
+        if (!ok || n != block->m_size)
+        {
+            xatomic::store(&m_error, 1);
+        }
+        block->m_size = 0;
+        xatomic::store(&block->m_state, STATE_FREE);
+    }
+
+    writebehind_stream_t::block_t* writebehind_stream_t::acquire_block(s64 pos)
+    {
+        while (true)
+        {
+            for (u32 i = 0; i < m_buffer_count; ++i)
+            {
+                block_t* block = &m_blocks[i];
+                if (xatomic::cas(&block->m_state, STATE_FREE, STATE_FILLING) == STATE_FREE)
+                {
+                    block->m_pos  = pos;
+                    block->m_size = 0;
+                    return block;
+                }
+            }
+
+            // All buffers are in flight, help the IO thread out
+            for (u32 i = 0; i < m_buffer_count; ++i)
+            {
+                block_t* block = &m_blocks[i];
+                if (xatomic::load(&block->m_state) == STATE_PENDING && m_queue->remove(block))
+                {
+                    write_block(block);
+                    break;
+                }
+            }
+
+            xatomic::pause();
+        }
+        return nullptr;
+    }
+
+    void writebehind_stream_t::submit_block(block_t* block)
+    {
+        // The state has to be set before the IO thread can see the job
+        xatomic::store(&block->m_state, STATE_PENDING);
+        m_queue->push(block);
+    }
+
+    istream_t* create_writebehind_stream(alloc_t* allocator, ioqueue_t* queue, u32 buffer_size, u32 buffer_count)
+    {
+        if (buffer_count < 2)
+            buffer_count = 2;
+        void* mem = allocator->allocate(sizeof(writebehind_stream_t), sizeof(void*));
+        return new (mem) writebehind_stream_t(allocator, queue, buffer_size, buffer_count);
+    }
+
+}; // namespace xcore
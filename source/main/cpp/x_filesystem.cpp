@@ -4,9 +4,15 @@
 #include "xfilesystem/x_fileinfo.h"
 #include "xfilesystem/x_dirpath.h"
 #include "xfilesystem/x_dirinfo.h"
+#include "xfilesystem/x_pathliteral.h"
+#include "xfilesystem/x_pathview.h"
+#include "xfilesystem/private/x_atomic.h"
 #include "xfilesystem/private/x_devicemanager.h"
 #include "xfilesystem/private/x_filesystem.h"
 #include "xfilesystem/private/x_filedevice.h"
+#include "xfilesystem/private/x_ioqueue.h"
+#include "xfilesystem/private/x_istream.h"
+#include "xfilesystem/private/x_pathtable.h"
 
 namespace xcore
 {
@@ -20,12 +26,20 @@ namespace xcore
     dirpath_t  filesystem_t::dirpath(const char* str) { return mImpl->dirpath(str); }
     filepath_t filesystem_t::filepath(const crunes_t& str) { return mImpl->filepath(str); }
     dirpath_t  filesystem_t::dirpath(const crunes_t& str) { return mImpl->dirpath(str); }
+    filepath_t filesystem_t::filepath(const path_literal_t& str) { return mImpl->filepath(str); }
+    dirpath_t  filesystem_t::dirpath(const path_literal_t& str) { return mImpl->dirpath(str); }
+    u32        filesystem_t::intern(const filepath_t& path) { return filesys_t::intern_path(filesys_t::get_path(path)); }
+    u32        filesystem_t::intern(const dirpath_t& path) { return filesys_t::intern_path(filesys_t::get_path(path)); }
+    u32        filesystem_t::parent(u32 pathid) { return mImpl->m_pathtable->parent(pathid); }
 
     stream_t  filesystem_t::open(const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op)
     {
         return mImpl->open(filename, mode, access, op);
     }
 
+    stream_t filesystem_t::open(buffer_t const& buffer, EFileAccess access) { return mImpl->open(buffer, access); }
+    stream_t filesystem_t::open(alloc_t* arena, u64 capacity) { return mImpl->open(arena, capacity); }
+
     void filesystem_t::close(stream_t& xs) { return mImpl->close(xs); }
 
     bool        filesystem_t::exists(fileinfo_t const& xfi) { return mImpl->exists(xfi); }
@@ -38,6 +52,17 @@ namespace xcore
     void    filesystem_t::rm(fileinfo_t const& xfi) { mImpl->rm(xfi); }
     void    filesystem_t::rm(dirinfo_t const& xdi) { mImpl->rm(xdi); }
 
+    stream_t filesystem_t::open(filepath_view const& filename, EFileMode mode, EFileAccess access, EFileOp op) { return mImpl->open(filename, mode, access, op); }
+    bool     filesystem_t::exists(filepath_view const& fp) { return mImpl->exists(fp); }
+    bool     filesystem_t::exists(dirpath_view const& dp) { return mImpl->exists(dp); }
+    s64      filesystem_t::size(filepath_view const& fp) { return mImpl->size(fp); }
+    bool     filesystem_t::attrs(filepath_view const& fp, fileattrs_t& attrs) { return mImpl->attrs(fp, attrs); }
+    bool     filesystem_t::times(filepath_view const& fp, filetimes_t& times) { return mImpl->times(fp, times); }
+    bool     filesystem_t::syspath(filepath_view const& fp, runes_t& syspath) { return mImpl->syspath(fp, syspath); }
+    bool     filesystem_t::syspath(dirpath_view const& dp, runes_t& syspath) { return mImpl->syspath(dp, syspath); }
+
+    void doIO(io_thread_t* io_thread) { filesys_t::process_io(io_thread); }
+
     // -----------------------------------------------------------
     // -----------------------------------------------------------
     // -----------------------------------------------------------
@@ -70,15 +95,409 @@ namespace xcore
     path_t const& filesys_t::get_path(filepath_t const& filepath) { return filepath.m_path; }
     filesys_t* filesys_t::get_filesystem(dirpath_t const& dirpath) { return dirpath.m_context->m_owner; }
     filesys_t* filesys_t::get_filesystem(filepath_t const& filepath) { return filepath.m_context->m_owner; }
+    void       filesys_t::process_io(io_thread_t* io_thread) { filesystem_t::mImpl->m_ioqueue->process(io_thread); }
+
+    stream_t filesys_t::decorate(stream_t& inner, create_decorator_fn create, u32 arg)
+    {
+        if (!inner.isOpen())
+            return stream_t();
+
+        alloc_t* allocator = inner.m_filehandle->m_owner->m_context.m_allocator;
+        stream_t stream(create(allocator, inner.m_pimpl, arg));
+        stream.m_filedevice = inner.m_filedevice;
+        stream.m_filehandle = inner.m_filehandle;
+        stream.m_fhid       = inner.m_fhid;
+        stream.m_caps       = inner.m_caps;
+
+        // The reference of inner on its implementation is taken over by the decorator
+        inner.m_filedevice = nullptr;
+        inner.m_filehandle = nullptr;
+        inner.close();
+        return stream;
+    }
+
+    stream_t filesys_t::subrange(stream_t& parent, u64 offset, u64 length)
+    {
+        if (!parent.isOpen())
+            return stream_t();
+
+        filehandle_t* pfh = parent.m_filehandle;
+        filesys_t*    fs  = pfh->m_owner;
+
+        // The range has its own handle, the OS handle is the one of the parent
+        filehandle_t* fh = fs->obtain_filehandle();
+        if (fh == nullptr)
+            return stream_t();
+        fh->m_handle = pfh->m_handle;
+        acquire_stream(parent.m_pimpl, pfh);
+
+        stream_t stream(create_subrange_stream(fs->m_context.m_allocator, parent.m_pimpl, pfh, offset, length));
+        stream.m_filedevice = parent.m_filedevice;
+        stream.m_filehandle = fh;
+        stream.m_fhid       = fh->m_id;
+        stream.m_caps       = parent.m_caps;
+        return stream;
+    }
+
+    void filesys_t::acquire_stream(istream_t* impl, filehandle_t* fh)
+    {
+        if (xatomic::load(&impl->m_copies) > 0)
+            xatomic::incr(&impl->m_copies);
+        else
+            xatomic::incr(&fh->m_refcount);
+    }
+
+    bool filesys_t::release_stream(istream_t* impl, filedevice_t* fd, filehandle_t* fh)
+    {
+        if (xatomic::load(&impl->m_copies) > 0)
+        {
+            // Closing an implementation that belongs to one stream releases the file handle itself
+            if (xatomic::decr(&impl->m_copies) != 0)
+                return false;
+            impl->close(fd, fh);
+            return true;
+        }
+
+        // Streams that share the file handle (copies and read-only opens of the same file) also share @impl
+        if (xatomic::decr(&fh->m_refcount) != 0)
+            return false;
+        filehandle_t* closed = fh;
+        impl->close(fd, closed);
+        fh->m_owner->release_filehandle(fh);
+        return true;
+    }
+
+    alloc_t* filesys_t::get_allocator(stream_t const& stream) { return stream.m_filehandle->m_owner->m_context.m_allocator; }
+
+    u32  filesys_t::intern_path(path_t const& path) { return filesystem_t::mImpl->m_pathtable->intern(path); }
+    void filesys_t::interned_path(u32 pathid, path_t& path) { filesystem_t::mImpl->m_pathtable->get_path(pathid, path); }
+
+    void filesys_t::init_filehandles()
+    {
+        // The index is stored in the lower 16 bits of the id
+        m_filehandle_count = m_context.m_max_file_handles;
+        if (m_filehandle_count > 0xFFFF)
+            m_filehandle_count = 0xFFFF;
+
+        m_filehandle_array       = (filehandle_t*)m_context.m_allocator->allocate(sizeof(filehandle_t) * m_filehandle_count, sizeof(void*));
+        m_filehandle_list_free   = nullptr;
+        m_filehandle_list_active = nullptr;
+        for (u32 i = m_filehandle_count; i > 0; --i)
+        {
+            filehandle_t* fh = new (&m_filehandle_array[i - 1]) filehandle_t();
+            fh->m_handle     = INVALID_FILE_HANDLE;
+            fh->m_owner      = this;
+            fh->m_refcount   = 0;
+            fh->m_salt       = 1;
+            fh->m_id         = (fh->m_salt << 16) | (i - 1);
+            fh->m_device     = nullptr;
+            fh->m_access     = FileAccess_Read;
+            fh->m_op         = FileOp_Sync;
+            fh->m_pins       = 0;
+            fh->m_reopening  = 0;
+            fh->m_lru_prev   = nullptr;
+            fh->m_lru_next   = nullptr;
+            fh->m_caps       = 0;
+            fh->m_path_hash  = 0;
+            fh->m_shared     = false;
+            fh->m_shared_next = nullptr;
+            fh->m_path.set_persistent(); // Outlives the path_arena of the thread that opens the file
+            fh->m_prev       = nullptr;
+            fh->m_next       = m_filehandle_list_free;
+            m_filehandle_list_free = fh;
+        }
+
+        m_oshandle_lru_head = nullptr;
+        m_oshandle_lru_tail = nullptr;
+        m_oshandle_count    = 0;
+
+        u32 table_size = 16;
+        while (table_size < m_filehandle_count)
+            table_size <<= 1;
+        m_shared_table      = (filehandle_t**)m_context.m_allocator->allocate(sizeof(filehandle_t*) * table_size, sizeof(void*));
+        m_shared_table_mask = table_size - 1;
+        for (u32 i = 0; i < table_size; ++i)
+            m_shared_table[i] = nullptr;
+    }
+
+    void filesys_t::exit_filehandles()
+    {
+        for (u32 i = 0; i < m_filehandle_count; ++i)
+        {
+            m_filehandle_array[i].~filehandle_t();
+        }
+        m_context.m_allocator->deallocate(m_filehandle_array);
+        m_context.m_allocator->deallocate(m_shared_table);
+        m_shared_table           = nullptr;
+        m_filehandle_array       = nullptr;
+        m_filehandle_list_free   = nullptr;
+        m_filehandle_list_active = nullptr;
+        m_filehandle_count       = 0;
+    }
+
+    filehandle_t* filesys_t::obtain_filehandle()
+    {
+        m_filehandle_lock.lock();
+        filehandle_t* fh = m_filehandle_list_free;
+        if (fh != nullptr)
+        {
+            m_filehandle_list_free = fh->m_next;
+
+            fh->m_prev = nullptr;
+            fh->m_next = m_filehandle_list_active;
+            if (m_filehandle_list_active != nullptr)
+                m_filehandle_list_active->m_prev = fh;
+            m_filehandle_list_active = fh;
+        }
+        m_filehandle_lock.unlock();
+
+        if (fh == nullptr)
+            return nullptr;
+
+        fh->m_handle   = INVALID_FILE_HANDLE;
+        fh->m_device   = nullptr;
+        fh->m_refcount = 1;
+        fh->m_pins     = 0;
+        return fh;
+    }
+
+    void filesys_t::release_filehandle(filehandle_t* fh)
+    {
+        // The OS handle has been closed already (see detach_oshandle)
+        fh->m_handle = INVALID_FILE_HANDLE;
+        fh->m_device = nullptr;
+        fh->m_path.clear();
+
+        // A new generation, ids handed out for the previous one become stale
+        fh->m_salt = (fh->m_salt + 1) & 0xFFFF;
+        if (fh->m_salt == 0)
+            fh->m_salt = 1;
+        fh->m_id = (fh->m_salt << 16) | (u32)(fh - m_filehandle_array);
+
+        m_filehandle_lock.lock();
+        if (fh->m_prev != nullptr)
+            fh->m_prev->m_next = fh->m_next;
+        else
+            m_filehandle_list_active = fh->m_next;
+        if (fh->m_next != nullptr)
+            fh->m_next->m_prev = fh->m_prev;
+
+        fh->m_prev             = nullptr;
+        fh->m_next             = m_filehandle_list_free;
+        m_filehandle_list_free = fh;
+        m_filehandle_lock.unlock();
+    }
+
+    filehandle_t* filesys_t::find_filehandle(u32 id)
+    {
+        u32 const index = id & 0xFFFF;
+        if (index >= m_filehandle_count)
+            return nullptr;
+        filehandle_t* fh = &m_filehandle_array[index];
+        return (fh->m_id == id) ? fh : nullptr;
+    }
+
+    void* filesys_t::acquire_oshandle(filedevice_t* fd, filehandle_t* fh)
+    {
+        m_filehandle_lock.lock();
+        while (fh->m_reopening != 0)
+        {
+            m_filehandle_lock.unlock();
+            xatomic::pause();
+            m_filehandle_lock.lock();
+        }
+
+        fh->m_pins += 1;
+        void* handle = fh->m_handle;
+        if (handle != INVALID_FILE_HANDLE || fh->m_device == nullptr)
+        {
+            if (handle != INVALID_FILE_HANDLE && fh->m_device != nullptr)
+            {
+                lru_remove(fh);
+                lru_push(fh);
+            }
+            m_filehandle_lock.unlock();
+            return handle;
+        }
+
+        // The OS handle was closed to make room for another one, open it again
+        fh->m_reopening = 1;
+        m_filehandle_lock.unlock();
+
+        make_room_for_oshandle();
+
+        filepath_t filepath;
+        filepath.m_context = &m_context;
+        filepath.m_path    = fh->m_path;
+        handle             = nullptr;
+        if (!fh->m_device->openFile(filepath, FileMode_Open, fh->m_access, fh->m_op, handle) || handle == nullptr)
+            handle = INVALID_FILE_HANDLE;
+        attach_oshandle(fh, handle);
+        return handle;
+    }
+
+    bool filesys_t::get_length_without_oshandle(filedevice_t* fd, filehandle_t* fh, u64& length)
+    {
+        m_filehandle_lock.lock();
+        bool const closed = (fh->m_handle == INVALID_FILE_HANDLE && fh->m_device != nullptr && fh->m_reopening == 0);
+        m_filehandle_lock.unlock();
+        if (!closed)
+            return false;
+
+        // The path of a file handle does not change while a stream refers to it
+        filepath_t filepath;
+        filepath.m_context = &m_context;
+        filepath.m_path    = fh->m_path;
+        return fd->getLengthOfFileByPath(filepath, length);
+    }
+
+    void filesys_t::release_oshandle(filehandle_t* fh)
+    {
+        m_filehandle_lock.lock();
+        fh->m_pins -= 1;
+        m_filehandle_lock.unlock();
+    }
+
+    // Takes the room that was made by make_room_for_oshandle(), @handle can be INVALID_FILE_HANDLE when opening failed
+    void filesys_t::attach_oshandle(filehandle_t* fh, void* handle)
+    {
+        m_filehandle_lock.lock();
+        fh->m_handle    = handle;
+        fh->m_reopening = 0;
+        if (handle != INVALID_FILE_HANDLE && fh->m_device != nullptr)
+            lru_push(fh);
+        else
+            m_oshandle_count -= 1;
+        m_filehandle_lock.unlock();
+    }
+
+    // Returns the OS handle so that it can be closed, after this the file handle cannot be opened again
+    void* filesys_t::detach_oshandle(filehandle_t* fh)
+    {
+        m_filehandle_lock.lock();
+        void* handle = fh->m_handle;
+        if (handle != INVALID_FILE_HANDLE && fh->m_device != nullptr)
+        {
+            lru_remove(fh);
+            m_oshandle_count -= 1;
+        }
+        fh->m_handle = INVALID_FILE_HANDLE;
+        fh->m_device = nullptr;
+        unshare_filehandle(fh);
+        m_filehandle_lock.unlock();
+        return handle;
+    }
+
+    filehandle_t* filesys_t::find_shared_filehandle(filedevice_t* fd, path_t const& path, u64 hash)
+    {
+        m_filehandle_lock.lock();
+        filehandle_t* fh = m_shared_table[(u32)hash & m_shared_table_mask];
+        while (fh != nullptr)
+        {
+            if (fh->m_path_hash == hash && fh->m_device == fd && compare(fh->m_path.m_path, path.m_path, fd->isCaseSensitive()) == 0)
+            {
+                // A handle of which the last stream is being closed cannot be taken anymore
+                s32 refcount = xatomic::load(&fh->m_refcount);
+                while (refcount > 0)
+                {
+                    s32 const current = xatomic::cas(&fh->m_refcount, refcount, refcount + 1);
+                    if (current == refcount)
+                        break;
+                    refcount = current;
+                }
+                if (refcount > 0)
+                    break;
+            }
+            fh = fh->m_shared_next;
+        }
+        m_filehandle_lock.unlock();
+        return fh;
+    }
+
+    void filesys_t::share_filehandle(filehandle_t* fh, u64 hash)
+    {
+        m_filehandle_lock.lock();
+        u32 const index   = (u32)hash & m_shared_table_mask;
+        fh->m_path_hash   = hash;
+        fh->m_shared      = true;
+        fh->m_shared_next = m_shared_table[index];
+        m_shared_table[index] = fh;
+        m_filehandle_lock.unlock();
+    }
+
+    // Called with the lock held
+    void filesys_t::unshare_filehandle(filehandle_t* fh)
+    {
+        if (!fh->m_shared)
+            return;
+        filehandle_t** link = &m_shared_table[(u32)fh->m_path_hash & m_shared_table_mask];
+        while (*link != fh)
+            link = &(*link)->m_shared_next;
+        *link             = fh->m_shared_next;
+        fh->m_shared_next = nullptr;
+        fh->m_shared      = false;
+    }
+
+    // Reserves room for one more OS handle, closing the least recently used idle ones when at m_max_open_files.
+    // When all OS handles are in use by an IO call the limit is exceeded for a moment instead of failing.
+    void filesys_t::make_room_for_oshandle()
+    {
+        m_filehandle_lock.lock();
+        while (m_oshandle_count >= m_context.m_max_open_files)
+        {
+            filehandle_t* victim = m_oshandle_lru_tail;
+            while (victim != nullptr && victim->m_pins > 0)
+                victim = victim->m_lru_prev;
+            if (victim == nullptr)
+                break;
+
+            lru_remove(victim);
+            m_oshandle_count -= 1;
+            filedevice_t* device = victim->m_device;
+            void*         handle = victim->m_handle;
+            victim->m_handle     = INVALID_FILE_HANDLE;
+
+            m_filehandle_lock.unlock();
+            device->closeFile(handle);
+            m_filehandle_lock.lock();
+        }
+        m_oshandle_count += 1;
+        m_filehandle_lock.unlock();
+    }
+
+    void filesys_t::lru_remove(filehandle_t* fh)
+    {
+        if (fh->m_lru_prev != nullptr)
+            fh->m_lru_prev->m_lru_next = fh->m_lru_next;
+        else
+            m_oshandle_lru_head = fh->m_lru_next;
+        if (fh->m_lru_next != nullptr)
+            fh->m_lru_next->m_lru_prev = fh->m_lru_prev;
+        else
+            m_oshandle_lru_tail = fh->m_lru_prev;
+        fh->m_lru_prev = nullptr;
+        fh->m_lru_next = nullptr;
+    }
+
+    void filesys_t::lru_push(filehandle_t* fh)
+    {
+        fh->m_lru_prev = nullptr;
+        fh->m_lru_next = m_oshandle_lru_head;
+        if (m_oshandle_lru_head != nullptr)
+            m_oshandle_lru_head->m_lru_prev = fh;
+        else
+            m_oshandle_lru_tail = fh;
+        m_oshandle_lru_head = fh;
+    }
 
     stream_t filesys_t::create_filestream(const filepath_t& filepath, EFileMode fm, EFileAccess fa, EFileOp fo)
     {
-        return stream_t();
+        return get_filesystem(filepath)->open(filepath, fm, fa, fo);
     }
 
     void       filesys_t::destroy(stream_t& stream)
     {
-
+        stream.close();
     }
     
     filepath_t filesys_t::filepath(const char* str)
@@ -107,14 +526,142 @@ namespace xcore
         return dirpath_t(&m_context, str);;
     }
 
+    filepath_t filesys_t::filepath(const path_literal_t& str)
+    {
+        filepath_t filepath;
+        filepath.m_context = &m_context;
+        filepath.m_path.m_context = &m_context;
+        filepath.m_path.adopt(crunes_t((utf8::pcrune)str.m_str, (utf8::pcrune)(str.m_str + str.m_len)), str.m_index, str.m_levels, str.m_ext, str.m_hash, str.m_hash_folded);
+        return filepath;
+    }
+
+    dirpath_t filesys_t::dirpath(const path_literal_t& str)
+    {
+        dirpath_t dirpath;
+        dirpath.m_context = &m_context;
+        dirpath.m_path.m_context = &m_context;
+        dirpath.m_path.adopt(crunes_t((utf8::pcrune)str.m_str, (utf8::pcrune)(str.m_str + str.m_len)), str.m_index, str.m_levels, str.m_ext, str.m_hash, str.m_hash_folded);
+        return dirpath;
+    }
+
     bool filesys_t::register_device(const crunes_t& device_name, filedevice_t* device) { return m_devman->add_device(device_name, device); }
 
     stream_t filesys_t::open(const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op) 
     {
-        return stream_t();
+        filedevice_t* device  = nullptr;
+        filepath_t    syspath = resolve(filename, device);
+        if (device == nullptr)
+            return stream_t();
+
+        // Positional reads do not disturb each other, so plain read-only streams of the same file share the OS handle
+        bool const lazy      = (mode == FileMode_Open && op == FileOp_Lazy);
+        bool const shareable = (mode == FileMode_Open && access == FileAccess_Read && (op == FileOp_Sync || lazy));
+        u64 const  hash      = shareable ? (device->isCaseSensitive() ? syspath.hash() : syspath.hash_folded()) : 0;
+        if (shareable)
+        {
+            filehandle_t* shared = find_shared_filehandle(device, syspath.m_path, hash);
+            if (shared != nullptr)
+            {
+                stream_t stream(get_filestream());
+                stream.m_filedevice = device;
+                stream.m_filehandle = shared;
+                stream.m_fhid       = shared->m_id;
+                stream.m_caps       = shared->m_caps;
+                return stream;
+            }
+        }
+
+        filehandle_t* fh = obtain_filehandle();
+        if (fh == nullptr)
+            return stream_t();
+
+        if (lazy)
+        {
+            // No OS handle yet, acquire_oshandle() opens the file on the first read or write. Only a file that
+            // exists is shared, a plain open of a missing file has to fail and not find this handle.
+            bool const share = shareable && device->hasFile(syspath);
+            fh->m_device = device;
+            fh->m_path   = static_cast<path_t&&>(syspath.m_path);
+            fh->m_access = access;
+            fh->m_op     = FileOp_Sync;
+            fh->m_caps   = filestream_caps(device, access, FileOp_Sync);
+            if (share)
+                share_filehandle(fh, hash);
+
+            stream_t stream(get_filestream());
+            stream.m_filedevice = device;
+            stream.m_filehandle = fh;
+            stream.m_fhid       = fh->m_id;
+            stream.m_caps       = fh->m_caps;
+            return stream;
+        }
+
+        make_room_for_oshandle();
+
+        u32   caps   = 0;
+        void* handle = open_filestream(device, syspath, mode, access, op, caps);
+        if (handle == nullptr || handle == INVALID_FILE_HANDLE)
+        {
+            attach_oshandle(fh, INVALID_FILE_HANDLE);
+            release_filehandle(fh);
+            return stream_t();
+        }
+
+        // What is needed to open the file again after the OS handle has been closed to make room
+        fh->m_device = device;
+        fh->m_path   = static_cast<path_t&&>(syspath.m_path);
+        fh->m_access = access;
+        fh->m_op     = op;
+        fh->m_caps   = caps;
+        attach_oshandle(fh, handle);
+        if (shareable)
+            share_filehandle(fh, hash);
+
+        istream_t* impl = get_filestream();
+        if (op == FileOp_Buffered && (access & FileAccess_Write) != 0)
+        {
+            impl = create_writebehind_stream(m_context.m_allocator, m_ioqueue, m_context.m_write_buffer_size, m_context.m_write_buffer_count);
+        }
+
+        stream_t stream(impl);
+        stream.m_filedevice = device;
+        stream.m_filehandle = fh;
+        stream.m_fhid       = fh->m_id;
+        stream.m_caps       = caps;
+        return stream;
     }
 
-    void filesys_t::close(stream_t& stream) {}
+    stream_t filesys_t::open(buffer_t const& buffer, EFileAccess access)
+    {
+        u32 caps = CAN_READ | CAN_SEEK | USE_READ | USE_SEEK;
+        if ((access & FileAccess_Write) != 0)
+            caps |= CAN_WRITE | USE_WRITE;
+
+        filehandle_t* fh = obtain_filehandle();
+        if (fh == nullptr)
+            return stream_t();
+
+        stream_t stream(create_memstream(m_context.m_allocator, buffer));
+        stream.m_filehandle = fh;
+        stream.m_fhid       = fh->m_id;
+        stream.m_caps       = caps;
+        return stream;
+    }
+
+    stream_t filesys_t::open(alloc_t* arena, u64 capacity)
+    {
+        filehandle_t* fh = obtain_filehandle();
+        if (fh == nullptr)
+            return stream_t();
+
+        stream_t stream(create_memstream(m_context.m_allocator, arena, capacity));
+        stream.m_filehandle = fh;
+        stream.m_fhid       = fh->m_id;
+        stream.m_caps       = CAN_READ | CAN_SEEK | CAN_WRITE | USE_READ | USE_SEEK | USE_WRITE;
+        return stream;
+    }
+
+    void filesys_t::close(stream_t& stream) { stream.close(); }
 
     bool       filesys_t::exists(fileinfo_t const&) { return false; }
     bool       filesys_t::exists(dirinfo_t const&) { return false; }
@@ -125,4 +672,70 @@ namespace xcore
     void       filesys_t::rm(fileinfo_t const&) {}
     void       filesys_t::rm(dirinfo_t const&) {}
 
+    filedevice_t* filesys_t::resolve(filepath_view const& fp, filepath_t& syspath)
+    {
+        syspath = filepath_t(&m_context);
+        return m_devman->find_device(fp.m_path, syspath.m_path);
+    }
+
+    filedevice_t* filesys_t::resolve(dirpath_view const& dp, dirpath_t& syspath)
+    {
+        syspath = dirpath_t(&m_context);
+        return m_devman->find_device(dp.m_path, syspath.m_path);
+    }
+
+    filedevice_t* filesys_t::resolve(crunes_t const& path, runes_t& syspath)
+    {
+        // A short path is normalized in the inline buffer of path_t, the result goes straight into @syspath
+        path_t normalized(&m_context, path);
+        return m_devman->find_device(normalized, syspath);
+    }
+
+    stream_t filesys_t::open(filepath_view const& filename, EFileMode mode, EFileAccess access, EFileOp op)
+    {
+        filepath_t filepath(&m_context, filename.m_path);
+        return open(filepath, mode, access, op);
+    }
+
+    bool filesys_t::exists(filepath_view const& fp)
+    {
+        filepath_t    syspath;
+        filedevice_t* device = resolve(fp, syspath);
+        return device != nullptr && device->hasFile(syspath);
+    }
+
+    bool filesys_t::exists(dirpath_view const& dp)
+    {
+        dirpath_t     syspath;
+        filedevice_t* device = resolve(dp, syspath);
+        return device != nullptr && device->hasDir(syspath);
+    }
+
+    s64 filesys_t::size(filepath_view const& fp)
+    {
+        filepath_t    syspath;
+        filedevice_t* device = resolve(fp, syspath);
+        u64           length = 0;
+        if (device == nullptr || !device->getLengthOfFileByPath(syspath, length))
+            return -1;
+        return (s64)length;
+    }
+
+    bool filesys_t::attrs(filepath_view const& fp, fileattrs_t& attrs)
+    {
+        filepath_t    syspath;
+        filedevice_t* device = resolve(fp, syspath);
+        return device != nullptr && device->getFileAttr(syspath, attrs);
+    }
+
+    bool filesys_t::times(filepath_view const& fp, filetimes_t& times)
+    {
+        filepath_t    syspath;
+        filedevice_t* device = resolve(fp, syspath);
+        return device != nullptr && device->getFileTime(syspath, times);
+    }
+
+    bool filesys_t::syspath(filepath_view const& fp, runes_t& syspath) { return resolve(fp.m_path, syspath) != nullptr; }
+    bool filesys_t::syspath(dirpath_view const& dp, runes_t& syspath) { return resolve(dp.m_path, syspath) != nullptr; }
+
 } // namespace xcore
\ No newline at end of file
@@ -16,6 +16,9 @@
 #include "xfilesystem/private/x_filedevice.h"
 #include "xfilesystem/private/x_filesystem.h"
 #include "xfilesystem/private/x_devicemanager.h"
+#include "xfilesystem/private/x_ioqueue.h"
+#include "xfilesystem/private/x_pathtable.h"
+#include "xfilesystem/private/x_stralloc.h"
 
 #include "xfilesystem/x_filesystem.h"
 #include "xfilesystem/x_filepath.h"
@@ -73,39 +76,6 @@ namespace xcore
             return length;
         }
 
-        //------------------------------------------------------------------------------
-        // The string allocator
-        class fs_utfalloc : public runes_alloc_t
-        {
-            alloc_t* m_allocator;
-
-        public:
-            fs_utfalloc(alloc_t* _allocator) : m_allocator(_allocator) {}
-            ~fs_utfalloc() {}
-
-            virtual runes_t allocate(s32 len, s32 cap, s32 type)
-            {
-                if (len > cap)
-                    cap = len;
-                runes_t str;
-                str.m_runes.m_utf32.m_bos      = (utf32::rune*)m_allocator->allocate((cap + 1) * sizeof(utf32::rune), sizeof(void*));
-                str.m_runes.m_utf32.m_str      = str.m_runes.m_utf32.m_bos;
-                str.m_runes.m_utf32.m_end      = str.m_runes.m_utf32.m_str + len;
-                str.m_runes.m_utf32.m_eos      = str.m_runes.m_utf32.m_str + cap;
-                str.m_runes.m_utf32.m_str[cap] = '\0';
-                str.m_runes.m_utf32.m_str[len] = '\0';
-                return str;
-            }
-
-            virtual void deallocate(runes_t& r)
-            {
-                m_allocator->deallocate(r.m_runes.m_utf32.m_bos);
-                r = runes_t();
-            }
-
-            XCORE_CLASS_PLACEMENT_NEW_DELETE
-        };
-
     } // namespace
 
     void filesystem_t::create(filesyscfg_t const& cfg)
@@ -113,10 +83,13 @@ namespace xcore
         filesys_t* imp      = cfg.m_allocator->construct<filesys_t>();
         imp->m_slash       = cfg.m_default_slash;
         imp->m_allocator   = cfg.m_allocator;
-        imp->m_stralloc    = cfg.m_allocator->construct<fs_utfalloc>(cfg.m_allocator);
+        imp->m_stralloc    = cfg.m_allocator->construct<stralloc_t>(cfg.m_allocator, cfg.m_path_type);
         filesystem_t::mImpl = imp;
 
         imp->m_devman = cfg.m_allocator->construct<devicemanager_t>(imp->m_stralloc);
+        imp->m_ioqueue = cfg.m_allocator->construct<ioqueue_t>();
+        imp->m_pathtable = cfg.m_allocator->construct<pathtable_t>(&imp->m_context);
+        imp->init_filehandles();
 
         // TODO: Register attach devices
 
@@ -161,9 +134,12 @@ namespace xcore
     void filesystem_t::destroy()
     {
         mImpl->m_devman->exit();
+        mImpl->exit_filehandles();
 
+        mImpl->m_allocator->destruct(mImpl->m_pathtable);
         mImpl->m_allocator->destruct(mImpl->m_stralloc);
         mImpl->m_allocator->destruct(mImpl->m_devman);
+        mImpl->m_allocator->destruct(mImpl->m_ioqueue);
         mImpl->m_allocator->destruct(mImpl);
         mImpl = nullptr;
     }
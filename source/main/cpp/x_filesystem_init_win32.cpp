@@ -13,6 +13,9 @@
 #include "xfilesystem/private/x_filedevice.h"
 #include "xfilesystem/private/x_filesystem.h"
 #include "xfilesystem/private/x_devicemanager.h"
+#include "xfilesystem/private/x_ioqueue.h"
+#include "xfilesystem/private/x_pathtable.h"
+#include "xfilesystem/private/x_stralloc.h"
 
 #include "xfilesystem/x_filesystem.h"
 #include "xfilesystem/x_filepath.h"
@@ -134,40 +137,6 @@ namespace xcore
                 driveIdx++;
             }
         }
-
-        //------------------------------------------------------------------------------
-        // The string allocator
-        class fs_utfalloc : public runes_alloc_t
-        {
-            alloc_t* m_allocator;
-
-        public:
-            fs_utfalloc(alloc_t* _allocator) : m_allocator(_allocator) {}
-
-            virtual runes_t allocate(s32 len, s32 cap, s32 type)
-            {
-                if (len > cap)
-                    cap = len;
-                runes_t str;
-                str.m_runes.m_utf32.m_bos      = (utf32::rune*)m_allocator->allocate((cap + 1) * sizeof(utf32::rune), sizeof(void*));
-                str.m_runes.m_utf32.m_str      = str.m_runes.m_utf32.m_bos;
-                str.m_runes.m_utf32.m_end      = str.m_runes.m_utf32.m_str + len;
-                str.m_runes.m_utf32.m_eos      = str.m_runes.m_utf32.m_str + cap;
-                str.m_runes.m_utf32.m_str[cap] = '\0';
-                str.m_runes.m_utf32.m_str[len] = '\0';
-                return str;
-            }
-
-            virtual void deallocate(runes_t& slice_t)
-            {
-                if (slice_t.is_nil())
-                    return;
-                m_allocator->deallocate(slice_t.m_runes.m_utf32.m_bos);
-                slice_t = runes_t();
-            }
-
-            XCORE_CLASS_PLACEMENT_NEW_DELETE
-        };
     } // namespace
 
     //------------------------------------------------------------------------------
@@ -176,10 +145,13 @@ namespace xcore
         filesys_t* imp      = ctxt.m_allocator->construct<filesys_t>();
         imp->m_context      = ctxt;
         imp->m_context.m_owner = imp;
-        imp->m_context.m_stralloc = ctxt.m_allocator->construct<fs_utfalloc>(ctxt.m_allocator);
+        imp->m_context.m_stralloc = ctxt.m_allocator->construct<stralloc_t>(ctxt.m_allocator, ctxt.m_path_type);
         filesystem_t::mImpl = imp;
 
         imp->m_devman = ctxt.m_allocator->construct<devicemanager_t>(&imp->m_context);
+        imp->m_ioqueue = ctxt.m_allocator->construct<ioqueue_t>();
+        imp->m_pathtable = ctxt.m_allocator->construct<pathtable_t>(&imp->m_context);
+        imp->init_filehandles();
         x_FileSystemRegisterSystemAliases(&imp->m_context, imp->m_devman);
 
         utf32::rune adir32[512] = {'\0'};
@@ -219,9 +191,12 @@ namespace xcore
     void filesystem_t::destroy()
     {
         mImpl->m_devman->exit();
+        mImpl->exit_filehandles();
 
+        mImpl->m_context.m_allocator->destruct(mImpl->m_pathtable);
         mImpl->m_context.m_allocator->destruct(mImpl->m_context.m_stralloc);
         mImpl->m_context.m_allocator->destruct(mImpl->m_devman);
+        mImpl->m_context.m_allocator->destruct(mImpl->m_ioqueue);
         mImpl->m_context.m_allocator->destruct(mImpl);
         mImpl = nullptr;
     }
@@ -18,8 +18,6 @@ namespace xcore
 
     bool isPathUNIXStyle(void) { return true; }
 
-    void doIO(io_thread_t* io_thread) {}
-
 }; // namespace xcore
 
 #endif // TARGET_PC
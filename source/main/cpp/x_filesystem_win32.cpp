@@ -24,8 +24,6 @@ namespace xcore
 
     bool isPathUNIXStyle(void) { return false; }
 
-    void doIO(io_thread_t* io_thread) {}
-
 }; // namespace xcore
 
 #endif // TARGET_PC
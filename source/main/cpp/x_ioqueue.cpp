@@ -0,0 +1,111 @@
+#include "xbase/x_target.h"
+#include "xbase/x_debug.h"
+
+#include "xfilesystem/x_threading.h"
+#include "xfilesystem/private/x_ioqueue.h"
+
+namespace xcore
+{
+    ioqueue_t::ioqueue_t() : m_lock(), m_head(nullptr), m_tail(nullptr), m_thread(nullptr) {}
+
+    void ioqueue_t::push(iojob_t* job)
+    {
+        job->m_next = nullptr;
+
+        m_lock.lock();
+        if (m_tail == nullptr)
+        {
+            m_head = job;
+        }
+        else
+        {
+            m_tail->m_next = job;
+        }
+        m_tail = job;
+
+        io_thread_t* const iothread = m_thread;
+        m_lock.unlock();
+
+        if (iothread != nullptr)
+        {
+            iothread->signal();
+        }
+    }
+
+    bool ioqueue_t::remove(iojob_t* job)
+    {
+        bool removed = false;
+
+        m_lock.lock();
+        iojob_t* prev = nullptr;
+        iojob_t* iter = m_head;
+        while (iter != nullptr)
+        {
+            if (iter == job)
+            {
+                if (prev == nullptr)
+                    m_head = iter->m_next;
+                else
+                    prev->m_next = iter->m_next;
+                if (m_tail == iter)
+                    m_tail = prev;
+                iter->m_next = nullptr;
+                removed      = true;
+                break;
+            }
+            prev = iter;
+            iter = iter->m_next;
+        }
+        m_lock.unlock();
+
+        return removed;
+    }
+
+    iojob_t* ioqueue_t::pop()
+    {
+        m_lock.lock();
+        iojob_t* job = m_head;
+        if (job != nullptr)
+        {
+            m_head = job->m_next;
+            if (m_head == nullptr)
+                m_tail = nullptr;
+            job->m_next = nullptr;
+        }
+        m_lock.unlock();
+        return job;
+    }
+
+    void ioqueue_t::process(io_thread_t* io_thread)
+    {
+        m_lock.lock();
+        m_thread = io_thread;
+        m_lock.unlock();
+
+        while (io_thread->quit() == false)
+        {
+            iojob_t* job = pop();
+            if (job != nullptr)
+            {
+                job->execute();
+            }
+            else
+            {
+                io_thread->wait();
+            }
+        }
+
+        m_lock.lock();
+        m_thread = nullptr;
+        m_lock.unlock();
+
+        // Do not leave any work behind
+        iojob_t* job = pop();
+        while (job != nullptr)
+        {
+            job->execute();
+            job = pop();
+        }
+    }
+
+}; // namespace xcore
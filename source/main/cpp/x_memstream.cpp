@@ -0,0 +1,208 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_buffer.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+
+#include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_istream.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // memstream_t:
+    //     Stream over a block of memory, either a user provided buffer that is
+    //     used as-is (fixed capacity, nothing is copied) or memory that is
+    //     obtained from an arena allocator and grows on demand.
+    //     The file device and file handle arguments are ignored.
+    //==============================================================================
+    class memstream_t : public istream_t
+    {
+    public:
+        memstream_t(alloc_t* allocator, alloc_t* arena, xbyte* data, u64 size, u64 capacity);
+        ~memstream_t();
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        virtual u64  getLength(filedevice_t* fd, filehandle_t* fh);
+        virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length);
+        virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos);
+        virtual void close(filedevice_t* fd, filehandle_t*& fh);
+        virtual void flush(filedevice_t* fd, filehandle_t* fh);
+        virtual s64  read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count);
+        virtual s64  write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count);
+        virtual xbyte const* borrow(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, s64 count);
+
+    protected:
+        bool reserve(u64 capacity);
+
+        alloc_t* m_allocator; // Allocator that this object was allocated with
+        alloc_t* m_arena;     // nullptr when wrapping a user buffer
+        xbyte*   m_data;
+        u64      m_size;
+        u64      m_capacity;
+    };
+
+    // x_memcopy, x_memset and alloc_t take 32-bit sizes, larger ranges are done in parts
+    static const u64 MAX_CHUNK = 0x80000000;
+
+    static void copy_bytes(xbyte* dst, xbyte const* src, u64 size)
+    {
+        while (size > 0)
+        {
+            u32 const n = (size > MAX_CHUNK) ? (u32)MAX_CHUNK : (u32)size;
+            x_memcopy(dst, src, n);
+            dst += n;
+            src += n;
+            size -= n;
+        }
+    }
+
+    static void clear_bytes(xbyte* dst, u64 size)
+    {
+        while (size > 0)
+        {
+            u32 const n = (size > MAX_CHUNK) ? (u32)MAX_CHUNK : (u32)size;
+            x_memset(dst, 0, n);
+            dst += n;
+            size -= n;
+        }
+    }
+
+    memstream_t::memstream_t(alloc_t* allocator, alloc_t* arena, xbyte* data, u64 size, u64 capacity)
+        : istream_t(1)
+        , m_allocator(allocator)
+        , m_arena(arena)
+        , m_data(data)
+        , m_size(size)
+        , m_capacity(capacity)
+    {
+        if (m_arena != nullptr && m_data == nullptr)
+        {
+            m_capacity = 0;
+            reserve(capacity);
+        }
+    }
+
+    memstream_t::~memstream_t()
+    {
+        if (m_arena != nullptr && m_data != nullptr)
+        {
+            m_arena->deallocate(m_data);
+        }
+    }
+
+    u64 memstream_t::getLength(filedevice_t* fd, filehandle_t* fh) { return m_size; }
+
+    void memstream_t::setLength(filedevice_t* fd, filehandle_t* fh, u64 length)
+    {
+        if (!reserve(length))
+            length = m_capacity;
+        if (length > m_size)
+        {
+            clear_bytes(m_data + m_size, length - m_size);
+        }
+        m_size = length;
+    }
+
+    s64 memstream_t::setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos)
+    {
+        s64 const old = current;
+        if ((caps & USE_SEEK) != 0 && pos >= 0)
+        {
+            current = pos;
+        }
+        return old;
+    }
+
+    void memstream_t::close(filedevice_t* fd, filehandle_t*& fh)
+    {
+        // The file handle only identifies the stream, there is no OS handle to close
+        fh->m_owner->release_filehandle(fh);
+
+        alloc_t* allocator = m_allocator;
+        allocator->destruct(this);
+    }
+
+    void memstream_t::flush(filedevice_t* fd, filehandle_t* fh) {}
+
+    s64 memstream_t::read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count)
+    {
+        if ((caps & USE_READ) == 0 || pos >= (s64)m_size)
+            return 0;
+        s64 const n = ((pos + count) > (s64)m_size) ? ((s64)m_size - pos) : count;
+        copy_bytes(buffer, m_data + pos, (u64)n);
+        pos += n;
+        return n;
+    }
+
+    s64 memstream_t::write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count)
+    {
+        if ((caps & USE_WRITE) == 0)
+            return 0;
+        if (!reserve((u64)(pos + count)))
+        {
+            if (pos >= (s64)m_capacity)
+                return 0;
+            count = (s64)m_capacity - pos;
+        }
+        if (pos > (s64)m_size)
+        {
+            clear_bytes(m_data + m_size, (u64)pos - m_size);
+        }
+        copy_bytes(m_data + pos, buffer, (u64)count);
+        pos += count;
+        if (pos > (s64)m_size)
+            m_size = (u64)pos;
+        return count;
+    }
+
+    xbyte const* memstream_t::borrow(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, s64 count)
+    {
+        if ((caps & USE_READ) == 0 || (pos + count) > (s64)m_size)
+            return nullptr;
+        xbyte const* ptr = m_data + pos;
+        pos += count;
+        return ptr;
+    }
+
+    bool memstream_t::reserve(u64 capacity)
+    {
+        if (capacity <= m_capacity)
+            return true;
+        // The arena cannot allocate more than 4GB at once, the stream does not grow beyond that
+        u64 const max_capacity = 0xFFFFFFFF;
+        if (m_arena == nullptr || capacity > max_capacity)
+            return false;
+
+        u64 newcap = m_capacity * 2;
+        if (newcap < capacity)
+            newcap = capacity;
+        if (newcap > max_capacity)
+            newcap = max_capacity;
+
+        xbyte* data = (xbyte*)m_arena->allocate((u32)newcap, sizeof(void*));
+        if (m_data != nullptr)
+        {
+            copy_bytes(data, m_data, m_size);
+            m_arena->deallocate(m_data);
+        }
+        m_data     = data;
+        m_capacity = newcap;
+        return true;
+    }
+
+    istream_t* create_memstream(alloc_t* allocator, buffer_t const& buffer)
+    {
+        void* mem = allocator->allocate(sizeof(memstream_t), sizeof(void*));
+        return new (mem) memstream_t(allocator, nullptr, buffer.m_mutable, buffer.m_len, buffer.m_len);
+    }
+
+    istream_t* create_memstream(alloc_t* allocator, alloc_t* arena, u64 capacity)
+    {
+        void* mem = allocator->allocate(sizeof(memstream_t), sizeof(void*));
+        return new (mem) memstream_t(allocator, arena, nullptr, 0, capacity);
+    }
+
+}; // namespace xcore
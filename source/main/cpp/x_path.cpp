@@ -1,58 +1,598 @@
 #include "xbase/x_target.h"
 #include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
 #include "xbase/x_runes.h"
 
 #include "xfilesystem/private/x_path.h"
 #include "xfilesystem/x_filepath.h"
 #include "xfilesystem/x_dirpath.h"
 #include "xfilesystem/x_enumerator.h"
+#include "xfilesystem/x_patharena.h"
 #include "xfilesystem/private/x_devicemanager.h"
 
+#if defined(TARGET_PC) && (defined(_M_X64) || defined(_M_IX86))
+#include <emmintrin.h>
+#define X_PATH_SSE2
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#include <emmintrin.h>
+#define X_PATH_SSE2
+#endif
+
 namespace xcore
 {
-    static utf32::rune sSlash                 = '\\';
-    static utf32::rune sSemiColumnSlashStr[3] = {':', '\\', 0};
+    // The delimiters are ascii, they match both utf32 and utf8 path runes
+    static uchar32     sSlash                 = '\\';
+    static ascii::rune sSemiColumnSlashStr[3] = {':', '\\', 0};
     static crunes_t    sSemiColumnSlash(sSemiColumnSlashStr, sSemiColumnSlashStr + 2);
 
-    static void fix_slashes(runes_t& str)
+    namespace xpath
+    {
+        // Fast pass, replaces '/' with '\' and tells if the path needs the slow pass. That is when a
+        // separator is followed by another separator or a '.', or when the path starts or ends with
+        // a separator or starts with a '.'. Most paths are clean and only ever see this pass.
+        template <class T> static bool fix_slashes_scalar(T* str, T* end, bool sep)
+        {
+            bool dirty = false;
+            for (; str < end; ++str)
+            {
+                if (*str == '/')
+                    *str = '\\';
+                bool const is_sep = (*str == '\\');
+                if (sep && (is_sep || *str == '.'))
+                    dirty = true;
+                sep = is_sep;
+            }
+            return dirty || sep;
+        }
+
+#if defined(X_PATH_SSE2)
+        static bool fix_slashes(utf8::rune* str, utf8::rune* end)
+        {
+            __m128i const fwd   = _mm_set1_epi8('/');
+            __m128i const back  = _mm_set1_epi8('\\');
+            __m128i const dot   = _mm_set1_epi8('.');
+            u32           carry = 1; // The start of the path counts as a separator
+            bool          dirty = false;
+            while ((end - str) >= 16)
+            {
+                __m128i   chunk  = _mm_loadu_si128((__m128i const*)str);
+                __m128i   is_fwd = _mm_cmpeq_epi8(chunk, fwd);
+                if (_mm_movemask_epi8(is_fwd) != 0)
+                {
+                    chunk = _mm_or_si128(_mm_andnot_si128(is_fwd, chunk), _mm_and_si128(is_fwd, back));
+                    _mm_storeu_si128((__m128i*)str, chunk);
+                }
+                u32 const sep  = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, back));
+                u32 const dots = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, dot));
+                if ((((sep << 1) | carry) & (sep | dots)) != 0)
+                    dirty = true;
+                carry = (sep >> 15) & 1;
+                str += 16;
+            }
+            return fix_slashes_scalar(str, end, carry != 0) || dirty;
+        }
+
+        static bool fix_slashes(utf32::rune* str, utf32::rune* end)
+        {
+            __m128i const fwd   = _mm_set1_epi32('/');
+            __m128i const back  = _mm_set1_epi32('\\');
+            __m128i const dot   = _mm_set1_epi32('.');
+            u32           carry = 1; // The start of the path counts as a separator
+            bool          dirty = false;
+            while ((end - str) >= 4)
+            {
+                __m128i   chunk  = _mm_loadu_si128((__m128i const*)str);
+                __m128i   is_fwd = _mm_cmpeq_epi32(chunk, fwd);
+                if (_mm_movemask_epi8(is_fwd) != 0)
+                {
+                    chunk = _mm_or_si128(_mm_andnot_si128(is_fwd, chunk), _mm_and_si128(is_fwd, back));
+                    _mm_storeu_si128((__m128i*)str, chunk);
+                }
+                u32 const sep  = (u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chunk, back)));
+                u32 const dots = (u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chunk, dot)));
+                if ((((sep << 1) | carry) & (sep | dots)) != 0)
+                    dirty = true;
+                carry = (sep >> 3) & 1;
+                str += 4;
+            }
+            return fix_slashes_scalar(str, end, carry != 0) || dirty;
+        }
+#else
+        static bool fix_slashes(utf8::rune* str, utf8::rune* end) { return fix_slashes_scalar(str, end, true); }
+        static bool fix_slashes(utf32::rune* str, utf32::rune* end) { return fix_slashes_scalar(str, end, true); }
+#endif
+        static bool fix_slashes(ascii::rune* str, ascii::rune* end) { return fix_slashes((utf8::rune*)str, (utf8::rune*)end); }
+
+        // Slow pass, collapses separators, removes the separators at the start and the end and resolves
+        // '.' and '..' segments. The result is never longer than the input, so this works in place.
+        // A '..' does not remove another '..', and one directly below the device ('Device:') is dropped since
+        // nothing is above the root of a device.
+        template <class T> static T* resolve_segments(T* str, T* end)
+        {
+            T*       w    = str;
+            T*       root = str;
+            T const* r    = str;
+            while (r < end)
+            {
+                if (*r == '\\')
+                {
+                    ++r;
+                    continue;
+                }
+
+                T const* seg = r;
+                while (r < end && *r != '\\')
+                    ++r;
+                s32 const n = (s32)(r - seg);
+                if (n == 1 && seg[0] == '.')
+                    continue;
+                if (n == 2 && seg[0] == '.' && seg[1] == '.' && w == root && root != str)
+                    continue;
+                if (n == 2 && seg[0] == '.' && seg[1] == '.' && w > root)
+                {
+                    T* prev = w;
+                    while (prev > root && *(prev - 1) != '\\')
+                        --prev;
+                    if (!((w - prev) == 2 && prev[0] == '.' && prev[1] == '.'))
+                    {
+                        w = (prev > root) ? (prev - 1) : root;
+                        continue;
+                    }
+                }
+
+                bool const first = (w == str);
+                if (!first)
+                    *w++ = '\\';
+                for (s32 i = 0; i < n; ++i)
+                    w[i] = seg[i];
+                w += n;
+                if (first && seg[n - 1] == ':')
+                    root = w;
+            }
+            return w;
+        }
+
+        template <class T> static T* normalize(T* str, T* end)
+        {
+            if (fix_slashes(str, end))
+                end = resolve_segments(str, end);
+            return end;
+        }
+    } // namespace xpath
+
+    // Native slashes only, no repeated separators, no separator at the start and the end and '.' and '..'
+    // segments resolved, e.g. '/data//textures/./../sounds/' becomes 'data\sounds'.
+    static void normalize(runes_t& str)
+    {
+        switch (str.m_type)
+        {
+            case ascii::TYPE:
+                if (str.m_runes.m_ascii.m_str != nullptr)
+                {
+                    str.m_runes.m_ascii.m_end  = xpath::normalize(str.m_runes.m_ascii.m_str, str.m_runes.m_ascii.m_end);
+                    *str.m_runes.m_ascii.m_end = '\0';
+                }
+                break;
+            case utf8::TYPE:
+                if (str.m_runes.m_utf8.m_str != nullptr)
+                {
+                    str.m_runes.m_utf8.m_end  = xpath::normalize(str.m_runes.m_utf8.m_str, str.m_runes.m_utf8.m_end);
+                    *str.m_runes.m_utf8.m_end = '\0';
+                }
+                break;
+            case utf32::TYPE:
+                if (str.m_runes.m_utf32.m_str != nullptr)
+                {
+                    str.m_runes.m_utf32.m_end  = xpath::normalize(str.m_runes.m_utf32.m_str, str.m_runes.m_utf32.m_end);
+                    *str.m_runes.m_utf32.m_end = '\0';
+                }
+                break;
+        }
+    }
+
+    s32 path_t::sizeof_rune(s32 type) { return (type == utf8::TYPE || type == ascii::TYPE) ? 1 : ((type == utf16::TYPE) ? 2 : 4); }
+
+    runes_t path_t::make_runes(void* mem, s32 len, s32 cap, s32 type)
+    {
+        runes_t str;
+        if (type == utf8::TYPE)
+        {
+            str.m_runes.m_utf8.m_bos      = (utf8::rune*)mem;
+            str.m_runes.m_utf8.m_str      = str.m_runes.m_utf8.m_bos;
+            str.m_runes.m_utf8.m_end      = str.m_runes.m_utf8.m_str + len;
+            str.m_runes.m_utf8.m_eos      = str.m_runes.m_utf8.m_str + cap;
+            str.m_runes.m_utf8.m_str[cap] = '\0';
+            str.m_runes.m_utf8.m_str[len] = '\0';
+            str.m_type                    = utf8::TYPE;
+        }
+        else
+        {
+            str.m_runes.m_utf32.m_bos      = (utf32::rune*)mem;
+            str.m_runes.m_utf32.m_str      = str.m_runes.m_utf32.m_bos;
+            str.m_runes.m_utf32.m_end      = str.m_runes.m_utf32.m_str + len;
+            str.m_runes.m_utf32.m_eos      = str.m_runes.m_utf32.m_str + cap;
+            str.m_runes.m_utf32.m_str[cap] = '\0';
+            str.m_runes.m_utf32.m_str[len] = '\0';
+            str.m_type                    = utf32::TYPE;
+        }
+        return str;
+    }
+
+    runes_t path_t::sbo_alloc_t::allocate(s32 len, s32 cap, s32 type)
+    {
+        // The extra capacity that is asked for is only slack, the inline buffer is used when len fits
+        s32 const path_type = m_owner->m_context->m_path_type;
+        s32 const sbo_cap   = ((s32)SBO_SIZE / sizeof_rune(path_type)) - 1;
+        if (m_owner->is_inline() || len > sbo_cap)
+        {
+            path_arena* arena = m_persistent ? nullptr : path_arena::current();
+            if (arena == nullptr)
+                return m_owner->m_context->m_stralloc->allocate(len, cap, path_type);
+
+            runes_t runes = arena->allocate(len, cap, path_type);
+            m_arena[(m_arena[0] == nullptr) ? 0 : 1] = runes.m_runes.m_ascii.m_bos;
+            return runes;
+        }
+
+        // The inline buffer is only handed out when it is not in use, so source and destination never overlap
+        return make_runes(m_owner->m_sbo, len, sbo_cap, path_type);
+    }
+
+    void path_t::sbo_alloc_t::deallocate(runes_t& slice)
     {
-        // Replace incorrect slashes with the correct one
-        findReplace(str, (uchar32)'/', sSlash);
+        if (slice.m_runes.m_ascii.m_bos == (ascii::prune)m_owner->m_sbo)
+        {
+            slice = runes_t();
+            return;
+        }
 
-        // Remove double slashes like '\\' or '//'
+        // Runes of an arena are given back when the arena is one of the calling thread, otherwise they stay until the
+        // arena goes. They never reach the string allocator, which expects its own header in front of the runes.
+        void const* bos = slice.m_runes.m_ascii.m_bos;
+        if (is_arena(bos))
+        {
+            m_arena[(bos == m_arena[0]) ? 0 : 1] = nullptr;
+            if (!path_arena::release(slice))
+                slice = runes_t();
+            return;
+        }
 
-        // Remove slashes at the start and end of this string
-        trimDelimiters(str, sSlash, sSlash);
+        ASSERT(!path_arena::contains(bos));
+        if (m_owner->m_context != nullptr)
+            m_owner->m_context->m_stralloc->deallocate(slice);
     }
 
-    path_t::path_t() : m_context(nullptr), m_path() {}
+    bool path_t::is_inline() const { return m_path.m_runes.m_ascii.m_bos == (ascii::pcrune)m_sbo; }
 
-    path_t::path_t(filesystem_t::context_t* ctxt) : m_context(ctxt), m_path() { fix_slashes(m_path); }
+    void path_t::set_persistent()
+    {
+        m_alloc.m_persistent = true;
+        if (is_inline() || !m_alloc.is_arena(m_path.m_runes.m_ascii.m_bos))
+            return;
 
-    path_t::path_t(filesystem_t::context_t* ctxt, const crunes_t& path) : m_context(ctxt)
+        // Copy the runes to memory of the string allocator (or the inline buffer), the index only holds offsets
+        bool const indexed = m_levels >= 0 && m_index_str == m_path.m_runes.m_ascii.m_str && m_index_end == m_path.m_runes.m_ascii.m_end;
+        runes_t    arena   = m_path;
+        m_path             = runes_t();
+        copy(arena, m_path, &m_alloc, 16);
+        m_alloc.deallocate(arena);
+        if (indexed)
+        {
+            m_index_str = m_path.m_runes.m_ascii.m_str;
+            m_index_end = m_path.m_runes.m_ascii.m_end;
+        }
+    }
+
+    path_t::path_t() : m_context(nullptr), m_path(), m_alloc(this), m_index_str(nullptr), m_index_end(nullptr), m_levels(-1), m_ext(-1), m_hash(0), m_hash_folded(0), m_index_cap(INDEX_INLINE), m_index(m_index_inline) {}
+
+    path_t::path_t(filesystem_t::context_t* ctxt) : m_context(ctxt), m_path(), m_alloc(this), m_index_str(nullptr), m_index_end(nullptr), m_levels(-1), m_ext(-1), m_hash(0), m_hash_folded(0), m_index_cap(INDEX_INLINE), m_index(m_index_inline) { normalize(m_path); }
+
+    path_t::path_t(filesystem_t::context_t* ctxt, const crunes_t& path) : m_context(ctxt), m_path(), m_alloc(this), m_index_str(nullptr), m_index_end(nullptr), m_levels(-1), m_ext(-1), m_hash(0), m_hash_folded(0), m_index_cap(INDEX_INLINE), m_index(m_index_inline)
     {
-        copy(path, m_path, m_context->m_stralloc, 16);
-        fix_slashes(m_path);
+        copy(path, m_path, &m_alloc, 16);
+        normalize(m_path);
+        update_index();
     }
 
-    path_t::path_t(const path_t& path) : m_context(path.m_context), m_path()
+    path_t::path_t(const path_t& path) : m_context(path.m_context), m_path(), m_alloc(this), m_index_str(nullptr), m_index_end(nullptr), m_levels(-1), m_ext(-1), m_hash(0), m_hash_folded(0), m_index_cap(INDEX_INLINE), m_index(m_index_inline)
     {
-        copy(path.m_path, m_path, m_context->m_stralloc, 16);
-        fix_slashes(m_path);
+        // @path is normalized already
+        copy(path.m_path, m_path, &m_alloc, 16);
+        copy_index(path);
     }
 
-    path_t::path_t(const path_t& lhspath, const path_t& rhspath) : m_context(lhspath.m_context), m_path()
+    path_t::path_t(path_t&& path) : m_context(path.m_context), m_path(), m_alloc(this), m_index_str(nullptr), m_index_end(nullptr), m_levels(-1), m_ext(-1), m_hash(0), m_hash_folded(0), m_index_cap(INDEX_INLINE), m_index(m_index_inline) { take(path); }
+
+    path_t::path_t(const path_t& lhspath, const path_t& rhspath) : m_context(lhspath.m_context), m_path(), m_alloc(this), m_index_str(nullptr), m_index_end(nullptr), m_levels(-1), m_ext(-1), m_hash(0), m_hash_folded(0), m_index_cap(INDEX_INLINE), m_index(m_index_inline)
     {
         // Combine both paths into a new path
-        concatenate(m_path, lhspath.m_path, rhspath.m_path, m_context->m_stralloc, 16);
+        concatenate(m_path, lhspath.m_path, rhspath.m_path, &m_alloc, 16);
+        normalize(m_path);
+        update_index();
     }
 
     path_t::~path_t()
     {
-        if (m_context != nullptr)
+        m_alloc.deallocate(m_path);
+        if (m_index != m_index_inline)
+            m_context->m_allocator->deallocate(m_index);
+    }
+
+    // Takes the runes and the level index of @path and leaves it empty, this path holds no runes and has the inline index.
+    // The runes of an inline path are copied into the inline buffer of this path, the index only holds offsets so it
+    // stays valid.
+    void path_t::take(path_t& path)
+    {
+        bool const indexed = path.m_levels >= 0 && path.m_index_str == path.m_path.m_runes.m_ascii.m_str && path.m_index_end == path.m_path.m_runes.m_ascii.m_end;
+
+        m_context = path.m_context;
+        m_path    = path.m_path;
+        void const* const bos = path.m_path.m_runes.m_ascii.m_bos;
+        if (path.m_alloc.is_arena(bos))
+        {
+            // Where the runes came from moves with them
+            path.m_alloc.m_arena[(bos == path.m_alloc.m_arena[0]) ? 0 : 1] = nullptr;
+            m_alloc.m_arena[(m_alloc.m_arena[0] == nullptr) ? 0 : 1] = bos;
+        }
+        if (path.is_inline())
+        {
+            x_memcopy(m_sbo, path.m_sbo, SBO_SIZE);
+            xbyte* const       dst = (xbyte*)m_sbo;
+            xbyte const* const src = (xbyte const*)path.m_sbo;
+            m_path.m_runes.m_ascii.m_bos = (ascii::prune)(dst + ((xbyte const*)path.m_path.m_runes.m_ascii.m_bos - src));
+            m_path.m_runes.m_ascii.m_str = (ascii::prune)(dst + ((xbyte const*)path.m_path.m_runes.m_ascii.m_str - src));
+            m_path.m_runes.m_ascii.m_end = (ascii::prune)(dst + ((xbyte const*)path.m_path.m_runes.m_ascii.m_end - src));
+            m_path.m_runes.m_ascii.m_eos = (ascii::prune)(dst + ((xbyte const*)path.m_path.m_runes.m_ascii.m_eos - src));
+        }
+        path.m_path = runes_t();
+
+        if (path.m_index != path.m_index_inline)
+        {
+            m_index          = path.m_index;
+            m_index_cap      = path.m_index_cap;
+            path.m_index     = path.m_index_inline;
+            path.m_index_cap = INDEX_INLINE;
+        }
+        else if (indexed)
+        {
+            s32 const n = (path.m_levels < INDEX_INLINE) ? path.m_levels : (s32)INDEX_INLINE;
+            x_memcopy(m_index_inline, path.m_index_inline, sizeof(u16) * 2 * n);
+        }
+
+        if (indexed)
+        {
+            m_levels      = path.m_levels;
+            m_ext         = path.m_ext;
+            m_hash        = path.m_hash;
+            m_hash_folded = path.m_hash_folded;
+            m_index_str   = m_path.m_runes.m_ascii.m_str;
+            m_index_end   = m_path.m_runes.m_ascii.m_end;
+        }
+        path.invalidate_index();
+
+        // The runes that were taken over can be from the path_arena
+        if (m_alloc.m_persistent)
+            set_persistent();
+    }
+
+    // Begin and end offset of every level after the device part ('Device:\'), empty levels are skipped.
+    // Returns the number of levels, which can be larger than @cap, only @cap levels are written.
+    template <class T> static s32 index_levels(T const* str, T const* end, u16* index, s32 cap, s32& ext)
+    {
+        // The offsets are stored as u16, a longer path would get a corrupt index
+        ASSERT((end - str) <= (s64)path_t::MAX_LENGTH);
+
+        T const* cursor = str;
+        for (T const* p = str; (p + 1) < end && *p != '\\'; ++p)
+        {
+            if (p[0] == ':' && p[1] == '\\')
+            {
+                cursor = p + 2;
+                break;
+            }
+        }
+
+        s32 levels = 0;
+        ext        = -1;
+        while (cursor < end)
+        {
+            if (*cursor == '\\')
+            {
+                ++cursor;
+                continue;
+            }
+            T const* level = cursor;
+            T const* dot   = nullptr;
+            for (; cursor < end && *cursor != '\\'; ++cursor)
+            {
+                if (*cursor == '.')
+                    dot = cursor;
+            }
+            if (levels < cap)
+            {
+                index[levels * 2]     = (u16)(level - str);
+                index[levels * 2 + 1] = (u16)(cursor - str);
+            }
+            ext = (dot != nullptr) ? (s32)(dot - str) : -1;
+            levels++;
+        }
+        return levels;
+    }
+
+    // FNV-1a (64-bit) over the code points of the path, the plain and the case-folded hash in one pass.
+    // Code points are hashed, not code units, the hash of a path does not depend on how its runes are stored.
+    static inline u32 next_rune(ascii::pcrune& str, ascii::pcrune end) { return (u32)(u8)*str++; }
+    static inline u32 next_rune(utf32::pcrune& str, utf32::pcrune end) { return *str++; }
+    static inline u32 next_rune(utf16::pcrune& str, utf16::pcrune end)
+    {
+        u32 c = *str++;
+        if (c >= 0xD800 && c < 0xDC00 && str < end)
+            c = 0x10000 + ((c - 0xD800) << 10) + ((u32)*str++ - 0xDC00);
+        return c;
+    }
+    static inline u32 next_rune(utf8::pcrune& str, utf8::pcrune end)
+    {
+        u32 c = *str++;
+        s32 n = 0;
+        if (c >= 0xF0)
+        {
+            c &= 0x07;
+            n = 3;
+        }
+        else if (c >= 0xE0)
+        {
+            c &= 0x0F;
+            n = 2;
+        }
+        else if (c >= 0xC0)
+        {
+            c &= 0x1F;
+            n = 1;
+        }
+        for (; n > 0 && str < end; --n)
+            c = (c << 6) | (*str++ & 0x3F);
+        return c;
+    }
+
+    template <class T> static void hash_runes(T str, T end, u64& hash, u64& hash_folded)
+    {
+        hash        = 0xCBF29CE484222325ULL;
+        hash_folded = 0xCBF29CE484222325ULL;
+        while (str < end)
+        {
+            u32 const c = next_rune(str, end);
+            u32 const l = (c >= 'A' && c <= 'Z') ? (c + ('a' - 'A')) : c;
+            hash        = (hash ^ c) * 0x100000001B3ULL;
+            hash_folded = (hash_folded ^ l) * 0x100000001B3ULL;
+        }
+    }
+
+    static void hash_runes(crunes_t const& str, u64& hash, u64& hash_folded)
+    {
+        switch (str.m_type)
+        {
+            case ascii::TYPE: hash_runes(str.m_runes.m_ascii.m_str, str.m_runes.m_ascii.m_end, hash, hash_folded); break;
+            case utf8::TYPE: hash_runes(str.m_runes.m_utf8.m_str, str.m_runes.m_utf8.m_end, hash, hash_folded); break;
+            case utf16::TYPE: hash_runes(str.m_runes.m_utf16.m_str, str.m_runes.m_utf16.m_end, hash, hash_folded); break;
+            case utf32::TYPE: hash_runes(str.m_runes.m_utf32.m_str, str.m_runes.m_utf32.m_end, hash, hash_folded); break;
+            default: hash_runes((ascii::pcrune)nullptr, (ascii::pcrune)nullptr, hash, hash_folded); break;
+        }
+    }
+
+    u64 path_t::hash(crunes_t const& str, bool folded)
+    {
+        u64 h, hf;
+        hash_runes(str, h, hf);
+        return folded ? hf : h;
+    }
+
+    u64 path_t::hash() const
+    {
+        update_index();
+        return m_hash;
+    }
+
+    u64 path_t::hash_folded() const
+    {
+        update_index();
+        return m_hash_folded;
+    }
+
+    void path_t::invalidate_index() { m_levels = -1; }
+
+    // The level index and the hashes of a copy are the ones of @path, the index only holds offsets. A path that
+    // is not indexed yet is indexed on the first query.
+    void path_t::copy_index(path_t const& path)
+    {
+        bool const indexed = path.m_levels >= 0 && path.m_index_str == path.m_path.m_runes.m_ascii.m_str && path.m_index_end == path.m_path.m_runes.m_ascii.m_end;
+        if (!indexed)
+        {
+            invalidate_index();
+            return;
+        }
+
+        if (path.m_levels > m_index_cap)
+        {
+            u16* index = (u16*)m_context->m_allocator->allocate(sizeof(u16) * 2 * path.m_levels, sizeof(u16));
+            if (m_index != m_index_inline)
+                m_context->m_allocator->deallocate(m_index);
+            m_index     = index;
+            m_index_cap = path.m_levels;
+        }
+        x_memcopy(m_index, path.m_index, sizeof(u16) * 2 * path.m_levels);
+        m_levels      = path.m_levels;
+        m_ext         = path.m_ext;
+        m_hash        = path.m_hash;
+        m_hash_folded = path.m_hash_folded;
+        m_index_str   = m_path.m_runes.m_ascii.m_str;
+        m_index_end   = m_path.m_runes.m_ascii.m_end;
+    }
+
+    void path_t::update_index() const
+    {
+        // Only the pointer values are used, they are the same for every member of the union
+        void const* str = m_path.m_runes.m_ascii.m_str;
+        void const* end = m_path.m_runes.m_ascii.m_end;
+        if (m_levels >= 0 && str == m_index_str && end == m_index_end)
+            return;
+
+        while (true)
+        {
+            s32 levels = 0;
+            switch (m_path.m_type)
+            {
+                case ascii::TYPE: levels = index_levels(m_path.m_runes.m_ascii.m_str, m_path.m_runes.m_ascii.m_end, m_index, m_index_cap, m_ext); break;
+                case utf8::TYPE: levels = index_levels(m_path.m_runes.m_utf8.m_str, m_path.m_runes.m_utf8.m_end, m_index, m_index_cap, m_ext); break;
+                case utf32::TYPE: levels = index_levels(m_path.m_runes.m_utf32.m_str, m_path.m_runes.m_utf32.m_end, m_index, m_index_cap, m_ext); break;
+            }
+            if (levels <= m_index_cap)
+            {
+                m_levels = levels;
+                break;
+            }
+
+            // Deep path, index it again in a larger array
+            u16* index = (u16*)m_context->m_allocator->allocate(sizeof(u16) * 2 * levels, sizeof(u16));
+            if (m_index != m_index_inline)
+                m_context->m_allocator->deallocate(m_index);
+            m_index     = index;
+            m_index_cap = levels;
+        }
+        hash_runes(crunes_t(m_path), m_hash, m_hash_folded);
+        m_index_str = str;
+        m_index_end = end;
+    }
+
+    s32 path_t::length() const
+    {
+        switch (m_path.m_type)
+        {
+            case ascii::TYPE: return (s32)(m_path.m_runes.m_ascii.m_end - m_path.m_runes.m_ascii.m_str);
+            case utf8::TYPE: return (s32)(m_path.m_runes.m_utf8.m_end - m_path.m_runes.m_utf8.m_str);
+            case utf32::TYPE: return (s32)(m_path.m_runes.m_utf32.m_end - m_path.m_runes.m_utf32.m_str);
+        }
+        return 0;
+    }
+
+    runes_t path_t::slice(s32 from, s32 to) const
+    {
+        runes_t r = m_path;
+        switch (m_path.m_type)
         {
-            m_context->m_stralloc->deallocate(m_path);
+            case ascii::TYPE:
+                r.m_runes.m_ascii.m_end = m_path.m_runes.m_ascii.m_str + to;
+                r.m_runes.m_ascii.m_str = m_path.m_runes.m_ascii.m_str + from;
+                break;
+            case utf8::TYPE:
+                r.m_runes.m_utf8.m_end = m_path.m_runes.m_utf8.m_str + to;
+                r.m_runes.m_utf8.m_str = m_path.m_runes.m_utf8.m_str + from;
+                break;
+            case utf32::TYPE:
+                r.m_runes.m_utf32.m_end = m_path.m_runes.m_utf32.m_str + to;
+                r.m_runes.m_utf32.m_str = m_path.m_runes.m_utf32.m_str + from;
+                break;
         }
+        return r;
     }
 
     path_t path_t::resolve(filesys_t* fs, filedevice_t*& outdevice) const
@@ -74,13 +614,16 @@ namespace xcore
         return path_t();
     }
 
-    void path_t::clear() { m_path.clear(); }
+    void path_t::clear()
+    {
+        m_path.clear();
+        invalidate_index();
+    }
 
     void path_t::erase()
     {
         clear();
-        if (m_context != nullptr)
-            m_context->m_stralloc->deallocate(m_path);
+        m_alloc.deallocate(m_path);
     }
 
     bool path_t::isEmpty() const { return m_path.is_empty(); }
@@ -126,14 +669,7 @@ namespace xcore
         erase();
         m_context = allocator;
         m_path  = runes_t;
-
-        // Replace incorrect slashes with the correct one
-        findReplace(m_path, (uchar32)'/', sSlash);
-
-        // Remove double slashes like '\\' or '//'
-
-        // Remove slash at the beginning and end
-        trim(m_path, sSlash);
+        normalize(m_path);
     }
 
     void path_t::set_dirpath(runes_t& runes_t, filesystem_t::context_t* allocator)
@@ -141,118 +677,73 @@ namespace xcore
         erase();
         m_context = allocator;
         m_path  = runes_t;
-
-        // Replace incorrect slashes with the correct one
-        findReplace(m_path, (uchar32)'/', sSlash);
-
-        // Remove double slashes like '\\' or '//'
-
-        // Remove slash at the beginning
-        trimLeft(m_path, sSlash);
+        normalize(m_path);
 
         // Ensure slash at the end
         if (!ends_with(m_path, sSlash))
         {
             crunes_t slashstr(sSemiColumnSlashStr + 1, sSemiColumnSlashStr + 2);
-            concatenate(m_path, slashstr, m_context->m_stralloc, 16);
+            concatenate(m_path, slashstr, &m_alloc, 16);
         }
     }
 
-    void path_t::combine(const path_t& dirpath, const path_t& otherpath)
+    void path_t::adopt(crunes_t const& normalized, u16 const* index, s32 levels, s32 ext, u64 hash, u64 hash_folded)
     {
         erase();
-        m_context = dirpath.m_context;
-        if (otherpath.isRooted())
-        {
-            runes_t relativefilepath = findSelectAfter(otherpath.m_path, sSemiColumnSlash);
-            concatenate(m_path, dirpath.m_path, relativefilepath, m_context->m_stralloc, 16);
-        }
-        else
+        copy(normalized, m_path, &m_alloc, 16);
+        if (index == nullptr || levels > m_index_cap)
         {
-            concatenate(m_path, dirpath.m_path, otherpath.m_path, m_context->m_stralloc, 16);
+            invalidate_index();
+            return;
         }
-    }
 
-    void path_t::copy_dirpath(runes_t& runes_t) { copy(runes_t, m_path, m_context->m_stralloc, 16); }
-
-    class enumerate_runes
-    {
-    public:
-        virtual bool operator()(s32 level, const runes_t& folder) = 0;
-    };
+        x_memcopy(m_index, index, sizeof(u16) * 2 * levels);
+        m_levels      = levels;
+        m_ext         = ext;
+        m_hash        = hash;
+        m_hash_folded = hash_folded;
+        m_index_str   = m_path.m_runes.m_ascii.m_str;
+        m_index_end   = m_path.m_runes.m_ascii.m_end;
+    }
 
-    static void enumerate_fn(const runes_t& dirpath, enumerate_runes& enumerator, bool right_to_left)
+    void path_t::combine(const path_t& dirpath, const path_t& otherpath)
     {
-        s32     level = 0;
-        runes_t path  = findSelectAfter(dirpath, sSemiColumnSlash);
-        if (right_to_left == false)
+        erase();
+        m_context = dirpath.m_context;
+        if (otherpath.isRooted())
         {
-            runes_t dir = selectBetween(path, sSlash, sSlash);
-            while (dir.is_empty() == false)
-            {
-                if (enumerator(level, dir) == false)
-                {
-                    break;
-                }
-                level++;
-                dir = selectNextBetween(path, dir, sSlash, sSlash);
-            }
+            runes_t relativefilepath = findSelectAfter(otherpath.m_path, sSemiColumnSlash);
+            concatenate(m_path, dirpath.m_path, relativefilepath, &m_alloc, 16);
         }
         else
         {
-            runes_t dir = selectBetweenLast(path, sSlash, sSlash);
-            while (dir.is_empty() == false)
-            {
-                if (enumerator(level, dir) == false)
-                {
-                    break;
-                }
-                level++;
-                dir = selectPreviousBetween(path, dir, sSlash, sSlash);
-            }
+            concatenate(m_path, dirpath.m_path, otherpath.m_path, &m_alloc, 16);
         }
     }
 
-    class folder_counting_enumerator : public enumerate_runes
+    void path_t::copy_dirpath(runes_t& runes_t)
     {
-    public:
-        s32 mLevels;
-        folder_counting_enumerator() : mLevels(0) {}
-        virtual bool operator()(s32 level, const runes_t& folder)
-        {
-            mLevels++;
-            return true;
-        }
-    };
+        copy(runes_t, m_path, &m_alloc, 16);
+        invalidate_index();
+    }
 
     s32 path_t::getLevels() const
     {
-        folder_counting_enumerator e;
-        enumerate_fn(m_path, e, false);
-        return e.mLevels;
+        update_index();
+        return m_levels;
     }
 
     bool path_t::getLevel(s32 level, path_t& outpath) const
     {
-        // Return the path at level @level
-        runez_t<ascii::rune, 4> device(":\\");
-
-        runes_t path = findSelectAfter(m_path, device);
-        if (path.is_empty())
+        // Return the name of the folder at level @level
+        update_index();
+        if (level < 0 || level >= m_levels)
             return false;
-        runes_t dir = selectBetween(m_path, sSlash, sSlash);
-        while (level > 0 && !dir.is_empty())
-        {
-            dir = selectNextBetween(m_path, dir, sSlash, sSlash);
-            level--;
-        }
-        if (!dir.is_empty())
-        {
-            runes_t path = selectAfterInclude(m_path, dir);
-            copy(path, outpath.m_path, outpath.m_context->m_stralloc, 16);
-            return true;
-        }
-        return false;
+        if (outpath.m_context == nullptr)
+            outpath.m_context = m_context;
+        copy(slice(level_begin(level), level_end(level)), outpath.m_path, outpath.alloc(), 16);
+        outpath.invalidate_index();
+        return true;
     }
 
     class folder_search_enumerator : public enumerate_delegate_t
@@ -275,39 +766,42 @@ namespace xcore
     s32 path_t::getLevelOf(const path_t& parent) const
     {
         // PARENT:   c:\disk
-        // THIS:     c:\disk\child
-        // RETURN 0
-        if (starts_with(m_path, parent.m_path)) {}
+        // THIS:     c:\disk\child\folder
+        // RETURN 2, 0 when THIS is PARENT and -1 when THIS is not inside PARENT
+        update_index();
+        parent.update_index();
+        if (parent.m_levels > m_levels)
+            return -1;
 
-        //@TODO: Implement this!
+        s32 const n = (parent.m_levels > 0) ? parent.level_end(parent.m_levels - 1) : parent.length();
+        if (n > length() || compare(slice(0, n), parent.slice(0, n)) != 0)
+            return -1;
 
-        return 0;
+        // 'c:\disk' is not the parent of 'c:\diskette'
+        if (parent.m_levels > 0 && level_end(parent.m_levels - 1) != n)
+            return -1;
+
+        return m_levels - parent.m_levels;
     }
 
     bool path_t::split(s32 level, path_t& parent_dirpath, path_t& relative_filepath) const
     {
-        // Split the path at level @level
-        runes_t path = findSelectAfter(m_path, sSemiColumnSlash);
-        if (path.is_empty())
+        // Split the path at level @level, the parent keeps the separator
+        update_index();
+        if (level < 0 || level >= m_levels)
             return false;
 
-        runes_t dir = selectBetween(m_path, sSlash, sSlash);
-        while (level > 0 && !dir.is_empty())
-        {
-            dir = selectNextBetween(m_path, dir, sSlash, sSlash);
-            level--;
-        }
+        if (parent_dirpath.m_context == nullptr)
+            parent_dirpath.m_context = m_context;
+        if (relative_filepath.m_context == nullptr)
+            relative_filepath.m_context = m_context;
 
-        if (!dir.is_empty())
-        {
-            runes_t parent_path = selectBeforeExclude(m_path, dir);
-            copy(parent_path, parent_dirpath.m_path, parent_dirpath.m_context->m_stralloc, 16);
-            runes_t relative_path = selectAfterInclude(m_path, dir);
-            copy(relative_path, relative_filepath.m_path, relative_filepath.m_context->m_stralloc, 16);
-            return true;
-        }
-
-        return false;
+        s32 const begin = level_begin(level);
+        copy(slice(0, begin), parent_dirpath.m_path, parent_dirpath.alloc(), 16);
+        copy(slice(begin, level_end(m_levels - 1)), relative_filepath.m_path, relative_filepath.alloc(), 16);
+        parent_dirpath.invalidate_index();
+        relative_filepath.invalidate_index();
+        return true;
     }
 
     void path_t::makeRelative()
@@ -316,6 +810,7 @@ namespace xcore
         {
             runes_t pos = findSelectUntilIncluded(m_path, sSemiColumnSlash);
             removeSelection(m_path, pos);
+            invalidate_index();
         }
     }
 
@@ -338,6 +833,7 @@ namespace xcore
         {
             runes_t remainder = selectAfterExclude(parentpath, overlap);
             keepOnlySelection(m_path, remainder);
+            invalidate_index();
         }
     }
 
@@ -348,12 +844,13 @@ namespace xcore
             runes_t rootpart = findSelectUntilIncluded(m_path, sSemiColumnSlash);
             if (rootpart.is_empty() == false)
             {
-                insert(m_path, in_root_dirpath.m_path, m_context->m_stralloc, 16);
+                insert(m_path, in_root_dirpath.m_path, &m_alloc, 16);
             }
             else
             {
-                replaceSelection(m_path, rootpart, in_root_dirpath.m_path, m_context->m_stralloc, 16);
+                replaceSelection(m_path, rootpart, in_root_dirpath.m_path, &m_alloc, 16);
             }
+            invalidate_index();
         }
     }
 
@@ -365,7 +862,7 @@ namespace xcore
             if (rootpart.is_empty() == false)
             {
                 root.erase();
-                copy(root.m_path, rootpart, root.m_context->m_stralloc, 16);
+                copy(root.m_path, rootpart, root.alloc(), 16);
                 return true;
             }
         }
@@ -380,11 +877,11 @@ namespace xcore
         outDirPath.clear();
         outDirPath.m_context = m_context;
 
-        // Select a string until and included the last '\'
-        runes_t dirpart = findLastSelectUntilIncluded(m_path, sSlash);
-        if (dirpart.is_empty() == false)
+        // Everything before the last level, including the separator
+        update_index();
+        if (m_levels > 0 && level_begin(m_levels - 1) > 0)
         {
-            copy(dirpart, outDirPath.m_path, outDirPath.m_context->m_stralloc, 16);
+            copy(slice(0, level_begin(m_levels - 1)), outDirPath.m_path, outDirPath.alloc(), 16);
             return true;
         }
         return false;
@@ -396,32 +893,33 @@ namespace xcore
 
     void path_t::getFilename(path_t& filename) const
     {
-        runes_t filenamepart = findLastSelectAfter(m_path, sSlash);
-        if (!filenamepart.is_empty())
+        update_index();
+        if (m_levels > 0)
         {
             filename.clear();
-            concatenate(filename.m_path, filenamepart, filename.m_context->m_stralloc, 16);
+            concatenate(filename.m_path, slice(level_begin(m_levels - 1), level_end(m_levels - 1)), filename.alloc(), 16);
         }
     }
 
     void path_t::getFilenameWithoutExtension(path_t& filename) const
     {
         filename.clear();
-        runes_t filenamepart = findLastSelectAfter(m_path, sSlash);
-        if (!filenamepart.is_empty())
+        update_index();
+        if (m_levels > 0)
         {
-            filenamepart = findLastSelectUntil(filenamepart, '.');
-            concatenate(filename.m_path, filenamepart, filename.m_context->m_stralloc, 16);
+            s32 const end = (m_ext >= 0) ? m_ext : level_end(m_levels - 1);
+            concatenate(filename.m_path, slice(level_begin(m_levels - 1), end), filename.alloc(), 16);
         }
     }
 
     void path_t::getExtension(path_t& filename) const
     {
         filename.clear();
-        runes_t filenamepart = findLastSelectAfter(m_path, sSlash);
-        runes_t filenameonly = findLastSelectUntil(filenamepart, '.');
-        runes_t fileext      = selectAfterExclude(filenamepart, filenameonly);
-        concatenate(filename.m_path, fileext, filename.m_context->m_stralloc, 16);
+        update_index();
+        if (m_levels > 0 && m_ext >= 0)
+        {
+            concatenate(filename.m_path, slice(m_ext, level_end(m_levels - 1)), filename.alloc(), 16);
+        }
     }
 
     path_t& path_t::operator=(const runes_t& path)
@@ -429,7 +927,8 @@ namespace xcore
         if (m_context != nullptr)
         {
             erase();
-            copy(path, m_path, m_context->m_stralloc, 16);
+            copy(path, m_path, &m_alloc, 16);
+            invalidate_index();
         }
         return *this;
     }
@@ -443,31 +942,56 @@ namespace xcore
         {
             if (path.m_context == m_context)
             {
-                copy(path.m_path, m_path, m_context->m_stralloc, 16);
+                copy(path.m_path, m_path, &m_alloc, 16);
             }
             else
             { // Allocator changed
-                m_context->m_stralloc->deallocate(m_path);
+                m_alloc.deallocate(m_path);
                 m_context = path.m_context;
-                copy(path.m_path, m_path, m_context->m_stralloc, 16);
+                copy(path.m_path, m_path, &m_alloc, 16);
             }
         }
         else
         {
             m_context = path.m_context;
-            copy(path.m_path, m_path, m_context->m_stralloc, 16);
+            copy(path.m_path, m_path, &m_alloc, 16);
         }
+        copy_index(path);
+        return *this;
+    }
+
+    path_t& path_t::operator=(path_t&& path)
+    {
+        if (this == &path)
+            return *this;
+
+        m_alloc.deallocate(m_path);
+        if (m_index != m_index_inline)
+        {
+            m_context->m_allocator->deallocate(m_index);
+            m_index     = m_index_inline;
+            m_index_cap = INDEX_INLINE;
+        }
+        take(path);
         return *this;
     }
 
     path_t& path_t::operator+=(const runes_t& r)
     {
-        concatenate(m_path, r, m_context->m_stralloc, 16);
+        concatenate(m_path, r, &m_alloc, 16);
+        invalidate_index();
         return *this;
     }
 
-    bool path_t::operator==(const path_t& rhs) const { return compare(m_path, rhs.m_path) == 0; }
-    bool path_t::operator!=(const path_t& rhs) const { return compare(m_path, rhs.m_path) != 0; }
+    // Different hashes means different paths, only paths with the same hash are compared rune by rune
+    bool path_t::operator==(const path_t& rhs) const
+    {
+        if (hash() != rhs.hash())
+            return false;
+        return compare(m_path, rhs.m_path) == 0;
+    }
+
+    bool path_t::operator!=(const path_t& rhs) const { return !(*this == rhs); }
 
     void path_t::toString(runes_t& dst) const
     {
@@ -0,0 +1,129 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_atomic.h"
+#include "xfilesystem/private/x_path.h"
+#include "xfilesystem/x_patharena.h"
+
+namespace xcore
+{
+    static X_THREAD_LOCAL path_arena* sCurrentArena = nullptr;
+
+    path_arena::path_arena(alloc_t* allocator, u32 block_size)
+        : m_allocator(allocator)
+        , m_block_size(block_size)
+        , m_blocks(nullptr)
+        , m_outer(sCurrentArena)
+    {
+        sCurrentArena = this;
+    }
+
+    path_arena::~path_arena()
+    {
+        ASSERT(sCurrentArena == this); // Arenas have to be destroyed in the reverse order of creation
+        sCurrentArena = m_outer;
+        while (m_blocks != nullptr)
+        {
+            block_t* next = m_blocks->m_next;
+            m_allocator->deallocate(m_blocks);
+            m_blocks = next;
+        }
+    }
+
+    path_arena::block_t* path_arena::new_block(u32 size)
+    {
+        if (size < m_block_size)
+            size = m_block_size;
+        block_t* block = (block_t*)m_allocator->allocate(sizeof(block_t) + size, sizeof(void*));
+        block->m_next  = m_blocks;
+        block->m_size  = size;
+        block->m_used  = 0;
+        m_blocks       = block;
+        return block;
+    }
+
+    runes_t path_arena::allocate(s32 len, s32 cap, s32 type)
+    {
+        if (cap < len)
+            cap = len;
+
+        // One extra rune for the terminator, rounded up to keep the next runes aligned
+        u32 const size  = ((u32)((cap + 1) * path_t::sizeof_rune(type)) + 3) & ~3;
+        block_t*  block = m_blocks;
+        if (block == nullptr || (block->m_size - block->m_used) < size)
+            block = new_block(size);
+
+        xbyte* mem = (xbyte*)(block + 1) + block->m_used;
+        block->m_used += size;
+        return path_t::make_runes(mem, len, cap, type);
+    }
+
+    void path_arena::deallocate(runes_t& slice)
+    {
+        // Growing a path gives back the runes that were allocated just before, those can be reused
+        block_t* block = m_blocks;
+        if (block != nullptr)
+        {
+            xbyte const* const begin = (xbyte const*)slice.m_runes.m_ascii.m_bos;
+            xbyte const* const end   = (xbyte const*)slice.m_runes.m_ascii.m_eos + path_t::sizeof_rune(slice.m_type);
+            xbyte const* const data  = (xbyte const*)(block + 1);
+            if (begin >= data && (u32)(((end - data) + 3) & ~3) == block->m_used)
+                block->m_used = (u32)(begin - data);
+        }
+        slice = runes_t();
+    }
+
+    bool path_arena::owns(void const* ptr) const
+    {
+        for (block_t const* block = m_blocks; block != nullptr; block = block->m_next)
+        {
+            xbyte const* const data = (xbyte const*)(block + 1);
+            if ((xbyte const*)ptr >= data && (xbyte const*)ptr < (data + block->m_size))
+                return true;
+        }
+        return false;
+    }
+
+    void path_arena::reset()
+    {
+        if (m_blocks == nullptr)
+            return;
+
+        // Keep the oldest block, it is the one that is most likely to be of the default size
+        while (m_blocks->m_next != nullptr)
+        {
+            block_t* next = m_blocks->m_next;
+            m_allocator->deallocate(m_blocks);
+            m_blocks = next;
+        }
+        m_blocks->m_used = 0;
+    }
+
+    path_arena* path_arena::current() { return sCurrentArena; }
+
+    bool path_arena::contains(void const* ptr)
+    {
+        for (path_arena const* arena = sCurrentArena; arena != nullptr; arena = arena->m_outer)
+        {
+            if (arena->owns(ptr))
+                return true;
+        }
+        return false;
+    }
+
+    bool path_arena::release(runes_t& slice)
+    {
+        for (path_arena* arena = sCurrentArena; arena != nullptr; arena = arena->m_outer)
+        {
+            if (arena->owns(slice.m_runes.m_ascii.m_bos))
+            {
+                arena->deallocate(slice);
+                return true;
+            }
+        }
+        return false;
+    }
+
+}; // namespace xcore
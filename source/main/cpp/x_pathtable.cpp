@@ -0,0 +1,241 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_path.h"
+#include "xfilesystem/private/x_pathtable.h"
+
+namespace xcore
+{
+    static ascii::rune sSlashStr[] = {'\\', 0};
+    static crunes_t    sSlash((ascii::pcrune)sSlashStr, (ascii::pcrune)(sSlashStr + 1));
+
+    // Hash of the code points of a name, the same name in another encoding gets the same hash
+    static u32 hash_name(crunes_t const& name)
+    {
+        u64 const hash = path_t::hash(name, false);
+        return (u32)(hash ^ (hash >> 32));
+    }
+
+    static inline u32 hash_node(u32 parent, u32 name)
+    {
+        u32 hash = (parent * 0x9E3779B1) ^ name;
+        hash ^= hash >> 15;
+        hash *= 0x85EBCA77;
+        hash ^= hash >> 13;
+        return hash;
+    }
+
+    template <class T> static inline crunes_t segment_runes(T const* str, T const* end) { return crunes_t(str, end); }
+    static inline crunes_t segment_runes(utf16::pcrune str, utf16::pcrune end)
+    {
+        crunes_t seg;
+        seg.m_runes.m_utf16.m_bos = str;
+        seg.m_runes.m_utf16.m_str = str;
+        seg.m_runes.m_utf16.m_end = end;
+        seg.m_runes.m_utf16.m_eos = end;
+        seg.m_type                = utf16::TYPE;
+        return seg;
+    }
+
+    // Both slashes separate segments and empty segments are skipped, 'a\b', 'a/b' and 'a\\b\' get the same id.
+    template <class T> static u32 intern_segments(pathtable_t* table, T const* str, T const* end)
+    {
+        u32      parent = 0;
+        T const* seg    = str;
+        for (; str <= end; ++str)
+        {
+            if (str == end || *str == '\\' || *str == '/')
+            {
+                if (str > seg)
+                    parent = table->intern(parent, segment_runes(seg, str));
+                seg = str + 1;
+            }
+        }
+        return parent;
+    }
+
+    template <class T> static void grow_array(alloc_t* allocator, T*& array, u32& cap, u32 count)
+    {
+        u32 const newcap = (cap == 0) ? 256 : (cap * 2);
+        T*        data   = (T*)allocator->allocate(sizeof(T) * newcap, sizeof(void*));
+        if (array != nullptr)
+        {
+            x_memcopy(data, array, sizeof(T) * count);
+            allocator->deallocate(array);
+        }
+        array = data;
+        cap   = newcap;
+    }
+
+    // The bucket array has as many entries as the capacity of the array of elements
+    template <class T> static void rehash(alloc_t* allocator, T* array, u32 count, u32 cap, u32*& buckets, u32& mask)
+    {
+        if (buckets != nullptr)
+            allocator->deallocate(buckets);
+        buckets = (u32*)allocator->allocate(sizeof(u32) * cap, sizeof(u32));
+        x_memset(buckets, 0, sizeof(u32) * cap);
+        mask = cap - 1;
+        for (u32 i = 1; i < count; ++i)
+        {
+            u32 const b     = array[i].m_hash & mask;
+            array[i].m_next = buckets[b];
+            buckets[b]      = i;
+        }
+    }
+
+    pathtable_t::pathtable_t(filesystem_t::context_t* ctxt)
+        : m_context(ctxt)
+        , m_names(nullptr)
+        , m_names_count(0)
+        , m_names_cap(0)
+        , m_names_buckets(nullptr)
+        , m_names_mask(0)
+        , m_nodes(nullptr)
+        , m_nodes_count(0)
+        , m_nodes_cap(0)
+        , m_nodes_buckets(nullptr)
+        , m_nodes_mask(0)
+    {
+        // Entry 0 is the empty name and the empty path
+        grow_array(m_context->m_allocator, m_names, m_names_cap, 0);
+        grow_array(m_context->m_allocator, m_nodes, m_nodes_cap, 0);
+        new (&m_names[0]) name_t();
+        m_names[0].m_hash = 0;
+        m_names[0].m_next = 0;
+        m_nodes[0].m_parent = 0;
+        m_nodes[0].m_name   = 0;
+        m_nodes[0].m_hash   = 0;
+        m_nodes[0].m_next   = 0;
+        m_names_count       = 1;
+        m_nodes_count       = 1;
+        rehash(m_context->m_allocator, m_names, m_names_count, m_names_cap, m_names_buckets, m_names_mask);
+        rehash(m_context->m_allocator, m_nodes, m_nodes_count, m_nodes_cap, m_nodes_buckets, m_nodes_mask);
+    }
+
+    pathtable_t::~pathtable_t()
+    {
+        for (u32 i = 1; i < m_names_count; ++i)
+        {
+            m_context->m_stralloc->deallocate(m_names[i].m_runes);
+        }
+        m_context->m_allocator->deallocate(m_names);
+        m_context->m_allocator->deallocate(m_names_buckets);
+        m_context->m_allocator->deallocate(m_nodes);
+        m_context->m_allocator->deallocate(m_nodes_buckets);
+    }
+
+    u32 pathtable_t::intern(path_t const& path)
+    {
+        runes_t const& r = path.m_path;
+        switch (r.m_type)
+        {
+            case ascii::TYPE: return intern_segments(this, r.m_runes.m_ascii.m_str, r.m_runes.m_ascii.m_end);
+            case utf8::TYPE: return intern_segments(this, r.m_runes.m_utf8.m_str, r.m_runes.m_utf8.m_end);
+            case utf16::TYPE: return intern_segments(this, r.m_runes.m_utf16.m_str, r.m_runes.m_utf16.m_end);
+            case utf32::TYPE: return intern_segments(this, r.m_runes.m_utf32.m_str, r.m_runes.m_utf32.m_end);
+        }
+        return 0;
+    }
+
+    u32 pathtable_t::intern(u32 parent, crunes_t const& name)
+    {
+        if (name.is_empty())
+            return parent;
+
+        m_lock.lock();
+        u32 const pathid = find_or_add_node(parent, find_or_add_name(name));
+        m_lock.unlock();
+        return pathid;
+    }
+
+    u32 pathtable_t::parent(u32 pathid)
+    {
+        m_lock.lock();
+        u32 const parent = (pathid < m_nodes_count) ? m_nodes[pathid].m_parent : 0;
+        m_lock.unlock();
+        return parent;
+    }
+
+    u32 pathtable_t::name(u32 pathid)
+    {
+        m_lock.lock();
+        u32 const name = (pathid < m_nodes_count) ? m_nodes[pathid].m_name : 0;
+        m_lock.unlock();
+        return name;
+    }
+
+    void pathtable_t::get_path(u32 pathid, path_t& path)
+    {
+        path = path_t(m_context);
+        m_lock.lock();
+        if (pathid != 0 && pathid < m_nodes_count)
+        {
+            build_path(pathid, path);
+        }
+        m_lock.unlock();
+    }
+
+    u32 pathtable_t::find_or_add_name(crunes_t const& name)
+    {
+        u32 const hash = hash_name(name);
+        for (u32 i = m_names_buckets[hash & m_names_mask]; i != 0; i = m_names[i].m_next)
+        {
+            if (m_names[i].m_hash == hash && compare(m_names[i].m_runes, name) == 0)
+                return i;
+        }
+
+        if (m_names_count == m_names_cap)
+        {
+            grow_array(m_context->m_allocator, m_names, m_names_cap, m_names_count);
+            rehash(m_context->m_allocator, m_names, m_names_count, m_names_cap, m_names_buckets, m_names_mask);
+        }
+
+        u32 const i     = m_names_count++;
+        name_t*   entry = new (&m_names[i]) name_t();
+        copy(name, entry->m_runes, m_context->m_stralloc, 0);
+        entry->m_hash = hash;
+        entry->m_next = m_names_buckets[hash & m_names_mask];
+        m_names_buckets[hash & m_names_mask] = i;
+        return i;
+    }
+
+    u32 pathtable_t::find_or_add_node(u32 parent, u32 name)
+    {
+        u32 const hash = hash_node(parent, name);
+        for (u32 i = m_nodes_buckets[hash & m_nodes_mask]; i != 0; i = m_nodes[i].m_next)
+        {
+            if (m_nodes[i].m_name == name && m_nodes[i].m_parent == parent)
+                return i;
+        }
+
+        if (m_nodes_count == m_nodes_cap)
+        {
+            grow_array(m_context->m_allocator, m_nodes, m_nodes_cap, m_nodes_count);
+            rehash(m_context->m_allocator, m_nodes, m_nodes_count, m_nodes_cap, m_nodes_buckets, m_nodes_mask);
+        }
+
+        u32 const i    = m_nodes_count++;
+        node_t&   node = m_nodes[i];
+        node.m_parent  = parent;
+        node.m_name    = name;
+        node.m_hash    = hash;
+        node.m_next    = m_nodes_buckets[hash & m_nodes_mask];
+        m_nodes_buckets[hash & m_nodes_mask] = i;
+        return i;
+    }
+
+    void pathtable_t::build_path(u32 pathid, path_t& path)
+    {
+        node_t const& node = m_nodes[pathid];
+        if (node.m_parent != 0)
+        {
+            build_path(node.m_parent, path);
+            concatenate(path.m_path, sSlash, path.alloc(), 16);
+        }
+        concatenate(path.m_path, m_names[node.m_name].m_runes, path.alloc(), 16);
+    }
+
+}; // namespace xcore
@@ -0,0 +1,84 @@
+#include "xbase/x_target.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_path.h"
+#include "xfilesystem/x_dirpath.h"
+#include "xfilesystem/x_filepath.h"
+#include "xfilesystem/x_pathview.h"
+
+namespace xcore
+{
+    // A view is not normalized, both slashes are separators. @rooted is set when the path starts with 'Device:\'.
+    template <class T> static bool validate_path(T const* str, T const* end, bool& rooted)
+    {
+        rooted = false;
+        if (str >= end)
+            return false;
+
+        bool separator = false;
+        for (T const* p = str; p < end; ++p)
+        {
+            u32 const c = (u32)*p;
+            if (c < 32 || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|')
+                return false;
+            if (c == '\\' || c == '/')
+            {
+                separator = true;
+            }
+            else if (c == ':')
+            {
+                // Only allowed once, at the end of a non-empty device name and followed by a separator
+                if (rooted || separator || p == str)
+                    return false;
+                if ((p + 1) < end && p[1] != '\\' && p[1] != '/')
+                    return false;
+                rooted = true;
+            }
+        }
+        return true;
+    }
+
+    static bool validate_path(crunes_t const& path, bool& rooted)
+    {
+        switch (path.m_type)
+        {
+            case ascii::TYPE: return validate_path(path.m_runes.m_ascii.m_str, path.m_runes.m_ascii.m_end, rooted);
+            case utf8::TYPE: return validate_path(path.m_runes.m_utf8.m_str, path.m_runes.m_utf8.m_end, rooted);
+            case utf16::TYPE: return validate_path(path.m_runes.m_utf16.m_str, path.m_runes.m_utf16.m_end, rooted);
+            case utf32::TYPE: return validate_path(path.m_runes.m_utf32.m_str, path.m_runes.m_utf32.m_end, rooted);
+        }
+        rooted = false;
+        return false;
+    }
+
+    filepath_view::filepath_view(filepath_t const& filepath) : m_path(filesys_t::get_path(filepath).m_path) {}
+
+    bool filepath_view::isValid() const
+    {
+        bool rooted;
+        return validate_path(m_path, rooted);
+    }
+
+    bool filepath_view::isRooted() const
+    {
+        bool rooted;
+        return validate_path(m_path, rooted) && rooted;
+    }
+
+    dirpath_view::dirpath_view(dirpath_t const& dirpath) : m_path(filesys_t::get_path(dirpath).m_path) {}
+
+    bool dirpath_view::isValid() const
+    {
+        bool rooted;
+        return validate_path(m_path, rooted);
+    }
+
+    bool dirpath_view::isRooted() const
+    {
+        bool rooted;
+        return validate_path(m_path, rooted) && rooted;
+    }
+
+}; // namespace xcore
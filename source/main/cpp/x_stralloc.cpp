@@ -0,0 +1,247 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_atomic.h"
+#include "xfilesystem/private/x_path.h"
+#include "xfilesystem/private/x_stralloc.h"
+
+namespace xcore
+{
+    struct stralloc_t::buffer_t
+    {
+        cache_t*  m_cache; // Cache of the thread that allocated the buffer, nullptr when it is not cached
+        s32       m_class; // -1 for a buffer that is too large to cache
+        buffer_t* m_next;  // Next buffer in a free list
+    };
+
+    struct stralloc_t::cache_t
+    {
+        buffer_t*      m_free[NUM_CLASSES];
+        s32            m_count[NUM_CLASSES];
+        void* volatile m_remote;       // Stack of buffers (buffer_t*) that were freed by other threads
+        s32 volatile   m_remote_count;
+        void const*    m_thread;       // Thread that uses the cache (see thread_key)
+        cache_t*       m_next;
+    };
+
+    // The caches of the calling thread, one for each allocator (by generation) that the thread uses, so that a
+    // thread that uses several allocators in turn keeps its buffers. Generation 0 is a free slot.
+    static X_THREAD_LOCAL void* sCaches[stralloc_t::THREAD_CACHES];
+    static X_THREAD_LOCAL u32   sCacheGenerations[stralloc_t::THREAD_CACHES];
+    static X_THREAD_LOCAL u32   sCacheReplace = 0;
+    static s32 volatile         sGeneration   = 0;
+
+    // Identifies the calling thread, a thread that takes the place of one that has exited can get the same key
+    // and then takes over its caches.
+    static inline void const* thread_key() { return &sCacheReplace; }
+
+    static void* find_thread_cache(u32 generation)
+    {
+        for (s32 i = 0; i < stralloc_t::THREAD_CACHES; ++i)
+        {
+            if (sCacheGenerations[i] == generation)
+                return sCaches[i];
+        }
+        return nullptr;
+    }
+
+    static s32 size_class(u32 size)
+    {
+        s32 sc = 0;
+        for (u32 s = stralloc_t::MIN_CLASS_SIZE; s < size; s <<= 1)
+            sc++;
+        return (sc < stralloc_t::NUM_CLASSES) ? sc : -1;
+    }
+
+    stralloc_t::stralloc_t(alloc_t* allocator, s32 type)
+        : m_allocator(allocator)
+        , m_type(type)
+        , m_generation((u32)xatomic::incr(&sGeneration))
+        , m_caches(nullptr)
+    {
+    }
+
+    stralloc_t::~stralloc_t()
+    {
+        // The slot of the calling thread is free again, the slots of other threads are taken over in turn
+        for (s32 i = 0; i < THREAD_CACHES; ++i)
+        {
+            if (sCacheGenerations[i] == m_generation)
+            {
+                sCaches[i]           = nullptr;
+                sCacheGenerations[i] = 0;
+            }
+        }
+
+        while (m_caches != nullptr)
+        {
+            cache_t* cache = m_caches;
+            m_caches       = cache->m_next;
+
+            reclaim(cache);
+            for (s32 sc = 0; sc < NUM_CLASSES; ++sc)
+            {
+                while (cache->m_free[sc] != nullptr)
+                {
+                    buffer_t* buffer   = cache->m_free[sc];
+                    cache->m_free[sc] = buffer->m_next;
+                    m_allocator->deallocate(buffer);
+                }
+            }
+            m_allocator->deallocate(cache);
+        }
+    }
+
+    stralloc_t::cache_t* stralloc_t::get_cache()
+    {
+        cache_t* cache = (cache_t*)find_thread_cache(m_generation);
+        if (cache != nullptr)
+            return cache;
+
+        // The cache that this thread had before its slot was taken by another allocator is used again
+        void const* const thread = thread_key();
+        m_lock.lock();
+        for (cache = m_caches; cache != nullptr && cache->m_thread != thread; cache = cache->m_next) {}
+        m_lock.unlock();
+
+        if (cache == nullptr)
+        {
+            cache = (cache_t*)m_allocator->allocate(sizeof(cache_t), sizeof(void*));
+            x_memset(cache, 0, sizeof(cache_t));
+            cache->m_thread = thread;
+            m_lock.lock();
+            cache->m_next = m_caches;
+            m_caches      = cache;
+            m_lock.unlock();
+        }
+
+        // A free slot, or else the slots are taken in turn. A cache that loses its slot stays with the allocator,
+        // the buffers that are freed to it meanwhile wait on its remote list.
+        s32 slot = -1;
+        for (s32 i = 0; i < THREAD_CACHES && slot < 0; ++i)
+        {
+            if (sCacheGenerations[i] == 0)
+                slot = i;
+        }
+        if (slot < 0)
+        {
+            slot          = (s32)(sCacheReplace % THREAD_CACHES);
+            sCacheReplace = sCacheReplace + 1;
+        }
+        sCaches[slot]           = cache;
+        sCacheGenerations[slot] = m_generation;
+        return cache;
+    }
+
+    // Takes back all the buffers that other threads have freed
+    void stralloc_t::reclaim(cache_t* cache)
+    {
+        buffer_t* list = (buffer_t*)xatomic::xchgptr(&cache->m_remote, nullptr);
+        while (list != nullptr)
+        {
+            xatomic::decr(&cache->m_remote_count);
+            buffer_t* next = list->m_next;
+            release(cache, list);
+            list = next;
+        }
+    }
+
+    void stralloc_t::release(cache_t* cache, buffer_t* buffer)
+    {
+        s32 const sc = buffer->m_class;
+        if (cache->m_count[sc] >= MAX_CACHED)
+        {
+            m_allocator->deallocate(buffer);
+            return;
+        }
+        buffer->m_next    = cache->m_free[sc];
+        cache->m_free[sc] = buffer;
+        cache->m_count[sc]++;
+    }
+
+    runes_t stralloc_t::allocate(s32 len, s32 cap, s32 type)
+    {
+        if (len > cap)
+            cap = len;
+
+        s32 const rune = path_t::sizeof_rune(m_type);
+        u32 const size = (u32)((cap + 1) * rune);
+        s32 const sc   = size_class(size);
+
+        buffer_t* buffer = nullptr;
+        cache_t*  cache  = nullptr;
+        if (sc >= 0)
+        {
+            cache = get_cache();
+            if (cache->m_free[sc] == nullptr)
+                reclaim(cache);
+
+            buffer = cache->m_free[sc];
+            if (buffer != nullptr)
+            {
+                cache->m_free[sc] = buffer->m_next;
+                cache->m_count[sc]--;
+            }
+            else
+            {
+                buffer = (buffer_t*)m_allocator->allocate(sizeof(buffer_t) + (MIN_CLASS_SIZE << sc), sizeof(void*));
+            }
+
+            // The runes can use the whole buffer
+            cap = (s32)((MIN_CLASS_SIZE << sc) / rune) - 1;
+        }
+        else
+        {
+            buffer = (buffer_t*)m_allocator->allocate(sizeof(buffer_t) + size, sizeof(void*));
+        }
+
+        buffer->m_cache = cache;
+        buffer->m_class = sc;
+        buffer->m_next  = nullptr;
+        return path_t::make_runes(buffer + 1, len, cap, m_type);
+    }
+
+    void stralloc_t::deallocate(runes_t& slice)
+    {
+        if (slice.is_nil())
+            return;
+
+        buffer_t* buffer = (buffer_t*)slice.m_runes.m_ascii.m_bos - 1;
+        slice            = runes_t();
+        if (buffer->m_class < 0)
+        {
+            m_allocator->deallocate(buffer);
+            return;
+        }
+
+        cache_t* const cache = (cache_t*)find_thread_cache(m_generation);
+        if (buffer->m_cache == cache)
+        {
+            release(cache, buffer);
+            return;
+        }
+
+        // Another thread owns the buffer, it takes it back the next time it runs out of buffers. That thread may
+        // have exited, so only a limited number of buffers wait for it.
+        if (xatomic::incr(&buffer->m_cache->m_remote_count) > MAX_REMOTE)
+        {
+            xatomic::decr(&buffer->m_cache->m_remote_count);
+            m_allocator->deallocate(buffer);
+            return;
+        }
+        void* volatile* remote = &buffer->m_cache->m_remote;
+        void*           head   = *remote;
+        while (true)
+        {
+            buffer->m_next       = (buffer_t*)head;
+            void* const previous = xatomic::casptr(remote, head, buffer);
+            if (previous == head)
+                break;
+            head = previous;
+        }
+    }
+
+}; // namespace xcore
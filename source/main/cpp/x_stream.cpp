@@ -3,7 +3,9 @@
 
 #include "xfilesystem/x_stream.h"
 #include "xfilesystem/private/x_istream.h"
+#include "xfilesystem/private/x_atomic.h"
 #include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filesystem.h"
 
 namespace xcore
 {
@@ -16,51 +18,154 @@ namespace xcore
         virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length) { }
         virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos) { return current; }
         virtual void close(filedevice_t* fd, filehandle_t*& fh) { }
+        virtual void flush(filedevice_t* fd, filehandle_t* fh) { }
         virtual s64 read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count) { return 0; }
         virtual s64 write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count) { return 0; }
     };
 
     static stream_nil sNullStreamImp;
 
+    u64 stream_reader_t::read(xbyte* buffer, u64 count) { return (u64)m_stream->read(buffer, (s64)count); }
+    u64 stream_writer_t::write(xbyte const* buffer, u64 count) { return (u64)m_stream->write(buffer, (s64)count); }
+
     stream_t::stream_t()
+        : m_filedevice(nullptr)
+        , m_filehandle(nullptr)
+        , m_fhid(0)
+        , m_pimpl(&sNullStreamImp)
+        , m_offset(0)
+        , m_length(-1)
+        , m_caps(NONE)
     {
+        m_reader.m_stream = this;
+        m_writer.m_stream = this;
+    }
 
+    stream_t::stream_t(const stream_t& other)
+        : m_filedevice(other.m_filedevice)
+        , m_filehandle(other.m_filehandle)
+        , m_fhid(other.m_fhid)
+        , m_pimpl(other.m_pimpl)
+        , m_offset(other.m_offset)
+        , m_length(other.m_length)
+        , m_caps(other.m_caps)
+    {
+        m_reader.m_stream = this;
+        m_writer.m_stream = this;
+        if (isOpen())
+        {
+            filesys_t::acquire_stream(m_pimpl, m_filehandle);
+        }
     }
 
-    stream_t::stream_t(const stream_t&)
+    stream_t::~stream_t() { close(); }
+
+    // A stream of which the file handle was released, and maybe handed to another stream since, does no IO.
+    // Streams without a file handle are not checked.
+    static inline bool is_stale(filehandle_t* fh, u32 fhid) { return fh != nullptr && fh->m_owner->find_filehandle(fhid) != fh; }
+
+    bool stream_t::canRead() const { return (m_caps & USE_READ) != 0; }
+    bool stream_t::canSeek() const { return (m_caps & USE_SEEK) != 0; }
+    bool stream_t::canWrite() const { return (m_caps & USE_WRITE) != 0; }
+
+    // A stream that refers to a handle that has been released (and possibly reused) is not open
+    bool stream_t::isOpen() const { return m_filehandle != nullptr && !is_stale(m_filehandle, m_fhid); }
+    bool stream_t::isAsync() const { return (m_caps & USE_ASYNC) != 0; }
+
+    u64 stream_t::getLength() const
     {
+        if (is_stale(m_filehandle, m_fhid))
+            return 0;
+        if (m_length < 0)
+        {
+            m_length = (s64)m_pimpl->getLength(m_filedevice, m_filehandle);
+        }
+        return (u64)m_length;
+    }
 
+    void stream_t::setLength(u64 length)
+    {
+        if (is_stale(m_filehandle, m_fhid))
+            return;
+        m_pimpl->setLength(m_filedevice, m_filehandle, length);
+        m_length = -1;
     }
 
-    stream_t::~stream_t()
+    s64 stream_t::getPos() const { return m_offset; }
+    s64 stream_t::setPos(s64 pos)
     {
+        if (is_stale(m_filehandle, m_fhid))
+            return m_offset;
+        return m_pimpl->setPos(m_filedevice, m_filehandle, m_caps, m_offset, pos);
+    }
 
+    void stream_t::close()
+    {
+        if (isOpen())
+        {
+            if (!filesys_t::release_stream(m_pimpl, m_filedevice, m_filehandle))
+            {
+                m_pimpl->flush(m_filedevice, m_filehandle);
+            }
+        }
+        m_filedevice = nullptr;
+        m_filehandle = nullptr;
+        m_fhid       = 0;
+        m_pimpl      = &sNullStreamImp;
+        m_offset     = 0;
+        m_length     = -1;
+        m_caps       = NONE;
     }
 
-    bool stream_t::canRead() const { return false; }
-    bool stream_t::canSeek() const{ return false; }
-    bool stream_t::canWrite() const{ return false; }
+    void stream_t::flush()
+    {
+        if (is_stale(m_filehandle, m_fhid))
+            return;
+        m_pimpl->flush(m_filedevice, m_filehandle);
+    }
 
-    bool stream_t::isOpen() const{ return false; }
-    bool stream_t::isAsync() const{ return false; }
+    s64 stream_t::read(xbyte* buffer, s64 count)
+    {
+        if (is_stale(m_filehandle, m_fhid))
+            return 0;
+        return m_pimpl->read(m_filedevice, m_filehandle, m_caps, m_offset, buffer, count);
+    }
 
-    u64  stream_t::getLength() const { return 0; }
-    void stream_t::setLength(u64 length) { }
-    s64  stream_t::getPos() const{ return 0; }
-    s64  stream_t::setPos(s64 pos){ return 0; }
+    s64 stream_t::write(xbyte const* buffer, s64 count)
+    {
+        if (is_stale(m_filehandle, m_fhid))
+            return 0;
+        s64 const n = m_pimpl->write(m_filedevice, m_filehandle, m_caps, m_offset, buffer, count);
+        if (m_length >= 0 && m_offset > m_length)
+        {
+            m_length = m_offset;
+        }
+        return n;
+    }
 
-    void stream_t::close() {}
-    void stream_t::flush() {}
+    xbyte const* stream_t::borrow(s64 count)
+    {
+        if (is_stale(m_filehandle, m_fhid))
+            return nullptr;
+        return m_pimpl->borrow(m_filedevice, m_filehandle, m_caps, m_offset, count);
+    }
 
-    s64 stream_t::read(xbyte*, s64){ return 0; }
-    s64 stream_t::write(xbyte const*, s64){ return 0; }
+    u64 stream_t::digest() const { return m_pimpl->digest(); }
 
-    reader_t* stream_t::get_reader(){ return 0; }
-    writer_t* stream_t::get_writer(){ return 0; }
+    reader_t* stream_t::get_reader() { return &m_reader; }
+    writer_t* stream_t::get_writer() { return &m_writer; }
 
     stream_t::stream_t(istream_t* impl)
+        : m_filedevice(nullptr)
+        , m_filehandle(nullptr)
+        , m_fhid(0)
+        , m_pimpl(impl)
+        , m_offset(0)
+        , m_length(-1)
+        , m_caps(NONE)
     {
-
+        m_reader.m_stream = this;
+        m_writer.m_stream = this;
     }
 
 }; // namespace xcore
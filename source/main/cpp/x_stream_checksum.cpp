@@ -0,0 +1,76 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+
+#include "xfilesystem/x_stream.h"
+#include "xfilesystem/private/x_checksum.h"
+#include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_istream.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // checksumstream_t:
+    //     Decorator that feeds all data that is read or written through it to a
+    //     checksum, in the order in which it passes. This removes the need for a
+    //     second pass over the data to verify it.
+    //==============================================================================
+    class checksumstream_t : public istream_t
+    {
+    public:
+        checksumstream_t(alloc_t* allocator, istream_t* inner, EChecksum algo)
+            : istream_t(1)
+            , m_allocator(allocator)
+            , m_inner(inner)
+            , m_checksum(algo)
+        {
+        }
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        virtual u64  getLength(filedevice_t* fd, filehandle_t* fh) { return m_inner->getLength(fd, fh); }
+        virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length) { m_inner->setLength(fd, fh, length); }
+        virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos) { return m_inner->setPos(fd, fh, caps, current, pos); }
+        virtual void flush(filedevice_t* fd, filehandle_t* fh) { m_inner->flush(fd, fh); }
+        virtual u64  digest() const { return m_checksum.digest(); }
+
+        virtual void close(filedevice_t* fd, filehandle_t*& fh)
+        {
+            filesys_t::release_stream(m_inner, fd, fh);
+
+            alloc_t* allocator = m_allocator;
+            allocator->destruct(this);
+        }
+
+        virtual s64 read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count)
+        {
+            s64 const n = m_inner->read(fd, fh, caps, pos, buffer, count);
+            if (n > 0)
+                m_checksum.update(buffer, (u64)n);
+            return n;
+        }
+
+        virtual s64 write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count)
+        {
+            s64 const n = m_inner->write(fd, fh, caps, pos, buffer, count);
+            if (n > 0)
+                m_checksum.update(buffer, (u64)n);
+            return n;
+        }
+
+    protected:
+        alloc_t*   m_allocator;
+        istream_t* m_inner;
+        checksum_t m_checksum;
+    };
+
+    istream_t* create_checksum_stream(alloc_t* allocator, istream_t* inner, u32 algo)
+    {
+        void* mem = allocator->allocate(sizeof(checksumstream_t), sizeof(void*));
+        return new (mem) checksumstream_t(allocator, inner, (EChecksum)algo);
+    }
+
+    stream_t xstream_checksum(stream_t& stream, EChecksum algo) { return filesys_t::decorate(stream, create_checksum_stream, (u32)algo); }
+
+}; // namespace xcore
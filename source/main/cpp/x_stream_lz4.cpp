@@ -0,0 +1,603 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+
+#include "xfilesystem/x_stream.h"
+#include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_istream.h"
+
+namespace xcore
+{
+    namespace xlz4
+    {
+        // LZ4 block format, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+        enum
+        {
+            MINMATCH    = 4,
+            LASTLITERALS = 5,
+            MFLIMIT     = 12,
+            MAXDISTANCE = 65535,
+            HASH_LOG    = 12,
+            HASH_SIZE   = 1 << HASH_LOG,
+        };
+
+        static inline u32 read32(xbyte const* p) { return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24); }
+        static inline u32 hash(u32 sequence) { return (sequence * 2654435761U) >> (32 - HASH_LOG); }
+
+        static inline s32 bound(s32 size) { return size + (size / 255) + 16; }
+
+        static inline xbyte* write_length(xbyte* op, s32 length)
+        {
+            while (length >= 255)
+            {
+                *op++ = 255;
+                length -= 255;
+            }
+            *op++ = (xbyte)length;
+            return op;
+        }
+
+        // Returns the compressed size, 0 when @dst is too small
+        static s32 compress(xbyte const* src, s32 srclen, xbyte* dst, s32 dstcap, u32* table)
+        {
+            x_memset(table, 0, HASH_SIZE * sizeof(u32));
+
+            xbyte*       op     = dst;
+            xbyte* const oend   = dst + dstcap;
+            s32          anchor = 0;
+            s32          ip     = 0;
+
+            s32 const mflimit    = srclen - MFLIMIT;
+            s32 const matchlimit = srclen - LASTLITERALS;
+            while (ip < mflimit)
+            {
+                u32 const sequence = read32(src + ip);
+                u32 const h        = hash(sequence);
+                s32 const ref      = (s32)table[h] - 1;
+                table[h]           = (u32)(ip + 1);
+                if (ref < 0 || (ip - ref) > MAXDISTANCE || read32(src + ref) != sequence)
+                {
+                    ip += 1;
+                    continue;
+                }
+
+                s32 mlen = MINMATCH;
+                while ((ip + mlen) < matchlimit && src[ref + mlen] == src[ip + mlen])
+                    mlen += 1;
+
+                s32 const litlen = ip - anchor;
+                if ((op + 1 + litlen + (litlen / 255) + 1 + 2 + (mlen / 255) + 1) > oend)
+                    return 0;
+
+                xbyte* token = op++;
+                if (litlen >= 15)
+                {
+                    *token = 15 << 4;
+                    op     = write_length(op, litlen - 15);
+                }
+                else
+                {
+                    *token = (xbyte)(litlen << 4);
+                }
+                x_memcopy(op, src + anchor, litlen);
+                op += litlen;
+
+                u32 const offset = (u32)(ip - ref);
+                *op++            = (xbyte)(offset & 0xFF);
+                *op++            = (xbyte)(offset >> 8);
+
+                s32 const ml = mlen - MINMATCH;
+                if (ml >= 15)
+                {
+                    *token |= 15;
+                    op = write_length(op, ml - 15);
+                }
+                else
+                {
+                    *token |= (xbyte)ml;
+                }
+
+                ip += mlen;
+                anchor = ip;
+            }
+
+            // Last literals
+            s32 const litlen = srclen - anchor;
+            if ((op + 1 + litlen + (litlen / 255) + 1) > oend)
+                return 0;
+            xbyte* token = op++;
+            if (litlen >= 15)
+            {
+                *token = 15 << 4;
+                op     = write_length(op, litlen - 15);
+            }
+            else
+            {
+                *token = (xbyte)(litlen << 4);
+            }
+            x_memcopy(op, src + anchor, litlen);
+            op += litlen;
+            return (s32)(op - dst);
+        }
+
+        // Returns the decompressed size, -1 when the input is malformed or @dst is too small
+        static s32 decompress(xbyte const* src, s32 srclen, xbyte* dst, s32 dstcap)
+        {
+            s32 ip = 0;
+            s32 op = 0;
+            while (ip < srclen)
+            {
+                u32 const token  = src[ip++];
+                s32       litlen = (s32)(token >> 4);
+                if (litlen == 15)
+                {
+                    u32 b;
+                    do
+                    {
+                        if (ip >= srclen)
+                            return -1;
+                        b = src[ip++];
+                        litlen += (s32)b;
+                    } while (b == 255);
+                }
+                if ((ip + litlen) > srclen || (op + litlen) > dstcap)
+                    return -1;
+                x_memcopy(dst + op, src + ip, litlen);
+                ip += litlen;
+                op += litlen;
+
+                // The last sequence only has literals
+                if (ip >= srclen)
+                    break;
+
+                if ((ip + 2) > srclen)
+                    return -1;
+                s32 const offset = (s32)src[ip] | ((s32)src[ip + 1] << 8);
+                ip += 2;
+                if (offset == 0 || offset > op)
+                    return -1;
+
+                s32 mlen = (s32)(token & 15);
+                if (mlen == 15)
+                {
+                    u32 b;
+                    do
+                    {
+                        if (ip >= srclen)
+                            return -1;
+                        b = src[ip++];
+                        mlen += (s32)b;
+                    } while (b == 255);
+                }
+                mlen += MINMATCH;
+                if ((op + mlen) > dstcap)
+                    return -1;
+
+                // Byte copy, source and destination may overlap
+                xbyte const* match = dst + op - offset;
+                for (s32 i = 0; i < mlen; ++i)
+                    dst[op + i] = match[i];
+                op += mlen;
+            }
+            return op;
+        }
+    } // namespace xlz4
+
+    //==============================================================================
+    // lz4stream_t:
+    //     Decorator that stores the data of the inner stream as LZ4 compressed
+    //     blocks. Layout of the inner stream:
+    //
+    //         header  { 'XLZ4', block size, length, block count, index offset }
+    //         block*  { stored size (bit 31 = not compressed), raw size, data }
+    //         index   { inner offset, uncompressed offset } * block count
+    //
+    //     The index makes it possible to seek to any position by decompressing
+    //     only the block that contains it. Writing is append-only, every flush()
+    //     writes the pending block, the index and the header so the inner stream
+    //     is always valid after a flush.
+    //     An empty inner stream is opened for writing, otherwise for reading.
+    //==============================================================================
+    class lz4stream_t : public istream_t
+    {
+    public:
+        enum
+        {
+            MAGIC          = 0x345A4C58, // 'XLZ4'
+            HEADER_SIZE    = 32,
+            BLOCK_RAW      = 0x80000000,
+            MIN_BLOCK_SIZE = 1024,
+            MAX_BLOCK_SIZE = 64 * 1024 * 1024, // A header with a larger (or zero) block size is not accepted
+        };
+
+        enum EMode
+        {
+            MODE_NONE  = 0,
+            MODE_READ  = 1,
+            MODE_WRITE = 2,
+        };
+
+        struct block_t
+        {
+            u64 m_offset; // Offset of the block in the inner stream
+            u64 m_start;  // Uncompressed position of the first byte of the block
+        };
+
+        lz4stream_t(alloc_t* allocator, istream_t* inner, u32 block_size);
+        ~lz4stream_t();
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        virtual u64  getLength(filedevice_t* fd, filehandle_t* fh);
+        virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length);
+        virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos);
+        virtual void close(filedevice_t* fd, filehandle_t*& fh);
+        virtual void flush(filedevice_t* fd, filehandle_t* fh);
+        virtual s64  read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count);
+        virtual s64  write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count);
+
+    protected:
+        void init(filedevice_t* fd, filehandle_t* fh, u32 caps);
+        bool load_block(filedevice_t* fd, filehandle_t* fh, u32 caps, u32 index);
+        void emit_block(filedevice_t* fd, filehandle_t* fh, u32 caps);
+        void write_index(filedevice_t* fd, filehandle_t* fh, u32 caps);
+        s32  find_block(u64 pos) const;
+        bool add_block(u64 offset, u64 start);
+
+        alloc_t*   m_allocator;
+        istream_t* m_inner;
+        EMode      m_mode;
+        u32        m_inner_caps;
+        u32        m_block_size;
+        xbyte*     m_block;       // Uncompressed data of the current block
+        u32        m_block_fill;  // Number of valid bytes in m_block
+        s32        m_block_index; // Index of the block in m_block (reading), -1 when none
+        xbyte*     m_cbuffer;     // Compressed data
+        u32*       m_table;       // Hash table for the compressor
+        block_t*   m_index;
+        u32        m_index_count;
+        u32        m_index_capacity;
+        u64        m_length;
+        u64        m_inner_end; // Where the next block is written
+    };
+
+    static inline void put_u32(xbyte* p, u32 v)
+    {
+        p[0] = (xbyte)(v);
+        p[1] = (xbyte)(v >> 8);
+        p[2] = (xbyte)(v >> 16);
+        p[3] = (xbyte)(v >> 24);
+    }
+    static inline void put_u64(xbyte* p, u64 v)
+    {
+        put_u32(p, (u32)v);
+        put_u32(p + 4, (u32)(v >> 32));
+    }
+    static inline u32 get_u32(xbyte const* p) { return xlz4::read32(p); }
+    static inline u64 get_u64(xbyte const* p) { return (u64)get_u32(p) | ((u64)get_u32(p + 4) << 32); }
+
+    lz4stream_t::lz4stream_t(alloc_t* allocator, istream_t* inner, u32 block_size)
+        : istream_t(1)
+        , m_allocator(allocator)
+        , m_inner(inner)
+        , m_mode(MODE_NONE)
+        , m_inner_caps(0)
+        , m_block_size(block_size)
+        , m_block(nullptr)
+        , m_block_fill(0)
+        , m_block_index(-1)
+        , m_cbuffer(nullptr)
+        , m_table(nullptr)
+        , m_index(nullptr)
+        , m_index_count(0)
+        , m_index_capacity(0)
+        , m_length(0)
+        , m_inner_end(HEADER_SIZE)
+    {
+        m_block   = (xbyte*)m_allocator->allocate(m_block_size, sizeof(void*));
+        m_cbuffer = (xbyte*)m_allocator->allocate(xlz4::bound(m_block_size), sizeof(void*));
+    }
+
+    lz4stream_t::~lz4stream_t()
+    {
+        if (m_table != nullptr)
+            m_allocator->deallocate(m_table);
+        if (m_index != nullptr)
+            m_allocator->deallocate(m_index);
+        m_allocator->deallocate(m_cbuffer);
+        m_allocator->deallocate(m_block);
+    }
+
+    void lz4stream_t::init(filedevice_t* fd, filehandle_t* fh, u32 caps)
+    {
+        if (m_mode != MODE_NONE)
+            return;
+
+        m_inner_caps = caps;
+        if (m_inner->getLength(fd, fh) == 0)
+        {
+            m_mode  = MODE_WRITE;
+            m_table = (u32*)m_allocator->allocate(xlz4::HASH_SIZE * sizeof(u32), sizeof(u32));
+            return;
+        }
+
+        m_mode = MODE_READ;
+
+        xbyte header[HEADER_SIZE];
+        s64   pos = 0;
+        if (m_inner->read(fd, fh, caps, pos, header, HEADER_SIZE) != HEADER_SIZE || get_u32(header) != MAGIC)
+            return;
+
+        u32 const block_size  = get_u32(header + 4);
+        u64 const length      = get_u64(header + 8);
+        u32 const block_count = get_u32(header + 16);
+        pos                   = (s64)get_u64(header + 24);
+        if (block_size == 0 || block_size > MAX_BLOCK_SIZE)
+            return;
+        if (block_size > m_block_size)
+        {
+            m_allocator->deallocate(m_cbuffer);
+            m_allocator->deallocate(m_block);
+            m_block_size = block_size;
+            m_block      = (xbyte*)m_allocator->allocate(m_block_size, sizeof(void*));
+            m_cbuffer    = (xbyte*)m_allocator->allocate(xlz4::bound(m_block_size), sizeof(void*));
+        }
+
+        for (u32 i = 0; i < block_count; ++i)
+        {
+            xbyte entry[16];
+            if (m_inner->read(fd, fh, caps, pos, entry, sizeof(entry)) != sizeof(entry))
+                break;
+            add_block(get_u64(entry), get_u64(entry + 8));
+        }
+        if (m_index_count == block_count)
+        {
+            m_length = length;
+        }
+    }
+
+    bool lz4stream_t::add_block(u64 offset, u64 start)
+    {
+        if (m_index_count == m_index_capacity)
+        {
+            u32 const capacity = (m_index_capacity == 0) ? 64 : (m_index_capacity * 2);
+            block_t*  index    = (block_t*)m_allocator->allocate(capacity * sizeof(block_t), sizeof(void*));
+            if (m_index != nullptr)
+            {
+                x_memcopy(index, m_index, m_index_count * sizeof(block_t));
+                m_allocator->deallocate(m_index);
+            }
+            m_index          = index;
+            m_index_capacity = capacity;
+        }
+        m_index[m_index_count].m_offset = offset;
+        m_index[m_index_count].m_start  = start;
+        m_index_count += 1;
+        return true;
+    }
+
+    s32 lz4stream_t::find_block(u64 pos) const
+    {
+        // Binary search for the last block that starts at or before @pos
+        s32 lo = 0;
+        s32 hi = (s32)m_index_count - 1;
+        s32 r  = -1;
+        while (lo <= hi)
+        {
+            s32 const mid = (lo + hi) / 2;
+            if (m_index[mid].m_start <= pos)
+            {
+                r  = mid;
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid - 1;
+            }
+        }
+        return r;
+    }
+
+    bool lz4stream_t::load_block(filedevice_t* fd, filehandle_t* fh, u32 caps, u32 index)
+    {
+        if (m_block_index == (s32)index)
+            return true;
+
+        m_block_index = -1;
+
+        xbyte header[8];
+        s64   pos = (s64)m_index[index].m_offset;
+        if (m_inner->read(fd, fh, caps, pos, header, sizeof(header)) != sizeof(header))
+            return false;
+
+        u32 const stored  = get_u32(header) & ~(u32)BLOCK_RAW;
+        u32 const rawsize = get_u32(header + 4);
+        if (rawsize > m_block_size || stored > (u32)xlz4::bound(m_block_size))
+            return false;
+
+        if ((get_u32(header) & BLOCK_RAW) != 0)
+        {
+            if (stored != rawsize || m_inner->read(fd, fh, caps, pos, m_block, stored) != (s64)stored)
+                return false;
+        }
+        else
+        {
+            if (m_inner->read(fd, fh, caps, pos, m_cbuffer, stored) != (s64)stored)
+                return false;
+            if (xlz4::decompress(m_cbuffer, (s32)stored, m_block, (s32)rawsize) != (s32)rawsize)
+                return false;
+        }
+
+        m_block_fill  = rawsize;
+        m_block_index = (s32)index;
+        return true;
+    }
+
+    void lz4stream_t::emit_block(filedevice_t* fd, filehandle_t* fh, u32 caps)
+    {
+        if (m_block_fill == 0)
+            return;
+
+        xbyte header[8];
+        s32   stored = xlz4::compress(m_block, (s32)m_block_fill, m_cbuffer, xlz4::bound(m_block_size), m_table);
+        xbyte const* data = m_cbuffer;
+        if (stored == 0 || stored >= (s32)m_block_fill)
+        {
+            // Incompressible, store as-is
+            stored = (s32)m_block_fill;
+            data   = m_block;
+            put_u32(header, (u32)stored | BLOCK_RAW);
+        }
+        else
+        {
+            put_u32(header, (u32)stored);
+        }
+        put_u32(header + 4, m_block_fill);
+
+        add_block(m_inner_end, m_length - m_block_fill);
+
+        s64 pos = (s64)m_inner_end;
+        m_inner->write(fd, fh, caps, pos, header, sizeof(header));
+        m_inner->write(fd, fh, caps, pos, data, stored);
+        m_inner_end  = (u64)pos;
+        m_block_fill = 0;
+    }
+
+    void lz4stream_t::write_index(filedevice_t* fd, filehandle_t* fh, u32 caps)
+    {
+        // The index is written after the last block, the next block will overwrite it
+        s64 pos = (s64)m_inner_end;
+        for (u32 i = 0; i < m_index_count; ++i)
+        {
+            xbyte entry[16];
+            put_u64(entry, m_index[i].m_offset);
+            put_u64(entry + 8, m_index[i].m_start);
+            m_inner->write(fd, fh, caps, pos, entry, sizeof(entry));
+        }
+
+        xbyte header[HEADER_SIZE];
+        x_memset(header, 0, HEADER_SIZE);
+        put_u32(header, MAGIC);
+        put_u32(header + 4, m_block_size);
+        put_u64(header + 8, m_length);
+        put_u32(header + 16, m_index_count);
+        put_u64(header + 24, m_inner_end);
+        pos = 0;
+        m_inner->write(fd, fh, caps, pos, header, HEADER_SIZE);
+        m_inner->flush(fd, fh);
+    }
+
+    u64 lz4stream_t::getLength(filedevice_t* fd, filehandle_t* fh)
+    {
+        // The length of a compressed stream is in its header. An empty inner stream is left alone, the first write
+        // opens it for writing with the capabilities of the stream.
+        if (m_mode == MODE_NONE && m_inner->getLength(fd, fh) != 0)
+            init(fd, fh, USE_READ | USE_SEEK);
+        return m_length;
+    }
+
+    void lz4stream_t::setLength(filedevice_t* fd, filehandle_t* fh, u64 length)
+    {
+        // Not supported, blocks cannot be truncated or extended
+    }
+
+    s64 lz4stream_t::setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos)
+    {
+        s64 const old = current;
+        if ((caps & USE_SEEK) != 0)
+        {
+            current = pos;
+        }
+        return old;
+    }
+
+    void lz4stream_t::close(filedevice_t* fd, filehandle_t*& fh)
+    {
+        if (m_mode == MODE_WRITE)
+        {
+            flush(fd, fh);
+        }
+        filesys_t::release_stream(m_inner, fd, fh);
+
+        alloc_t* allocator = m_allocator;
+        allocator->destruct(this);
+    }
+
+    void lz4stream_t::flush(filedevice_t* fd, filehandle_t* fh)
+    {
+        if (m_mode != MODE_WRITE)
+            return;
+        emit_block(fd, fh, m_inner_caps);
+        write_index(fd, fh, m_inner_caps);
+    }
+
+    s64 lz4stream_t::read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count)
+    {
+        init(fd, fh, caps);
+        if (m_mode != MODE_READ || (caps & USE_READ) == 0)
+            return 0;
+
+        s64 total = 0;
+        while (count > 0 && pos < (s64)m_length)
+        {
+            s32 const index = find_block((u64)pos);
+            if (index < 0 || !load_block(fd, fh, caps, (u32)index))
+                break;
+
+            u64 const offset = (u64)pos - m_index[index].m_start;
+            if (offset >= m_block_fill)
+                break;
+            s64 n = (s64)(m_block_fill - offset);
+            if (n > count)
+                n = count;
+            x_memcopy(buffer, m_block + offset, (u32)n);
+            buffer += n;
+            count -= n;
+            pos += n;
+            total += n;
+        }
+        return total;
+    }
+
+    s64 lz4stream_t::write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count)
+    {
+        init(fd, fh, caps);
+        if (m_mode != MODE_WRITE || (caps & USE_WRITE) == 0 || pos != (s64)m_length)
+            return 0;
+
+        s64 total = 0;
+        while (count > 0)
+        {
+            u32 n = m_block_size - m_block_fill;
+            if ((s64)n > count)
+                n = (u32)count;
+            x_memcopy(m_block + m_block_fill, buffer, n);
+            m_block_fill += n;
+            m_length += n;
+            buffer += n;
+            count -= n;
+            total += n;
+            if (m_block_fill == m_block_size)
+            {
+                emit_block(fd, fh, caps);
+            }
+        }
+        pos += total;
+        return total;
+    }
+
+    istream_t* create_lz4_stream(alloc_t* allocator, istream_t* inner, u32 block_size)
+    {
+        if (block_size < lz4stream_t::MIN_BLOCK_SIZE)
+            block_size = lz4stream_t::MIN_BLOCK_SIZE;
+        if (block_size > lz4stream_t::MAX_BLOCK_SIZE)
+            block_size = lz4stream_t::MAX_BLOCK_SIZE;
+        void* mem = allocator->allocate(sizeof(lz4stream_t), sizeof(void*));
+        return new (mem) lz4stream_t(allocator, inner, block_size);
+    }
+
+    stream_t xstream_lz4(stream_t& stream, u32 block_size) { return filesys_t::decorate(stream, create_lz4_stream, block_size); }
+
+}; // namespace xcore
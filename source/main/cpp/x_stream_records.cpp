@@ -0,0 +1,192 @@
+#include "xbase/x_target.h"
+#include "xbase/x_buffer.h"
+#include "xbase/x_debug.h"
+#include "xbase/x_memory.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/x_stream.h"
+
+#if defined(TARGET_PC) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define X_RECORDS_SSE2
+#define X_RECORDS_AVX2
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define X_RECORDS_SSE2
+#define X_RECORDS_AVX2
+#endif
+
+namespace xcore
+{
+    namespace xrecords
+    {
+        static inline u32 first_bit(u32 mask)
+        {
+#if defined(TARGET_PC)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return (u32)index;
+#elif defined(__GNUC__) || defined(__clang__)
+            return (u32)__builtin_ctz(mask);
+#else
+            u32 index = 0;
+            while ((mask & 1) == 0)
+            {
+                mask >>= 1;
+                index += 1;
+            }
+            return index;
+#endif
+        }
+
+        static xbyte const* find_scalar(xbyte const* str, xbyte const* end, xbyte c)
+        {
+            while (str < end)
+            {
+                if (*str == c)
+                    return str;
+                ++str;
+            }
+            return end;
+        }
+
+#if defined(X_RECORDS_SSE2)
+        static xbyte const* find_sse2(xbyte const* str, xbyte const* end, xbyte c)
+        {
+            __m128i const pattern = _mm_set1_epi8((char)c);
+            while ((end - str) >= 16)
+            {
+                __m128i const chunk = _mm_loadu_si128((__m128i const*)str);
+                u32 const     mask  = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern));
+                if (mask != 0)
+                    return str + first_bit(mask);
+                str += 16;
+            }
+            return find_scalar(str, end, c);
+        }
+#endif
+
+#if defined(X_RECORDS_AVX2)
+#if defined(TARGET_PC)
+        static bool has_avx2()
+        {
+            s32 info[4];
+            __cpuid(info, 1);
+            bool const osxsave = (info[2] & (1 << 27)) != 0;
+            bool const avx     = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+                return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+        }
+#define X_RECORDS_TARGET_AVX2
+#else
+        // Runs during static initialization, before the CPU data of the compiler runtime is set up
+        static bool has_avx2()
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+        }
+#define X_RECORDS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+        static bool const sHasAvx2 = has_avx2();
+
+        X_RECORDS_TARGET_AVX2 static xbyte const* find_avx2(xbyte const* str, xbyte const* end, xbyte c)
+        {
+            __m256i const pattern = _mm256_set1_epi8((char)c);
+            while ((end - str) >= 32)
+            {
+                __m256i const chunk = _mm256_loadu_si256((__m256i const*)str);
+                u32 const     mask  = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern));
+                if (mask != 0)
+                    return str + first_bit(mask);
+                str += 32;
+            }
+            return find_sse2(str, end, c);
+        }
+#endif
+
+        // Returns a pointer to the first @c in [str, end), or end when not found
+        static inline xbyte const* find(xbyte const* str, xbyte const* end, xbyte c)
+        {
+#if defined(X_RECORDS_AVX2)
+            if (sHasAvx2)
+                return find_avx2(str, end, c);
+#endif
+#if defined(X_RECORDS_SSE2)
+            return find_sse2(str, end, c);
+#else
+            return find_scalar(str, end, c);
+#endif
+        }
+    } // namespace xrecords
+
+    record_reader_t::record_reader_t(reader_t* reader, buffer_t& buffer, char delimiter)
+        : m_reader(reader)
+        , m_data(buffer.m_mutable)
+        , m_size(buffer.m_len)
+        , m_begin(0)
+        , m_end(0)
+        , m_scanned(0)
+        , m_eof(false)
+        , m_delimiter(delimiter)
+    {
+    }
+
+    bool record_reader_t::next(crunes_t& record)
+    {
+        while (true)
+        {
+            xbyte const* str = m_data + m_begin;
+            xbyte const* end = m_data + m_end;
+            xbyte const* pos = xrecords::find(m_data + m_scanned, end, (xbyte)m_delimiter);
+            if (pos < end)
+            {
+                record    = crunes_t((ascii::pcrune)str, (ascii::pcrune)pos);
+                m_begin   = (u64)(pos - m_data) + 1;
+                m_scanned = m_begin;
+                return true;
+            }
+
+            // No delimiter in what is left, the partial record is kept and the buffer is refilled
+            m_scanned = m_end;
+            if (!m_eof && refill())
+                continue;
+
+            // A record without a delimiter, either the last one or one that does not fit in the buffer
+            if (m_begin == m_end)
+                return false;
+            record    = crunes_t((ascii::pcrune)str, (ascii::pcrune)end);
+            m_begin   = m_end;
+            m_scanned = m_end;
+            return true;
+        }
+    }
+
+    bool record_reader_t::refill()
+    {
+        // Move the partial record to the start of the buffer, only when the buffer is full
+        // with a single record there is no space left to read into.
+        if (m_begin > 0)
+        {
+            u64 const n = m_end - m_begin;
+            x_memmove(m_data, m_data + m_begin, n); // The regions overlap when the record is longer than m_begin
+            m_end     = n;
+            m_scanned = n;
+            m_begin   = 0;
+        }
+        if (m_end == m_size)
+            return false;
+
+        u64 const n = m_reader->read(m_data + m_end, m_size - m_end);
+        if (n == 0)
+        {
+            m_eof = true;
+            return false;
+        }
+        m_end += n;
+        return true;
+    }
+
+}; // namespace xcore
@@ -0,0 +1,119 @@
+#include "xbase/x_target.h"
+#include "xbase/x_allocator.h"
+#include "xbase/x_debug.h"
+
+#include "xfilesystem/x_stream.h"
+#include "xfilesystem/private/x_atomic.h"
+#include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_istream.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // subrangestream_t:
+    //     View on [offset, offset + length) of a parent stream. The view holds a
+    //     reference on the parent stream, so the OS handle stays open until the
+    //     parent and all of its views are closed. Positions are
+    //     relative to the start of the range and are clamped to the range.
+    //==============================================================================
+    class subrangestream_t : public istream_t
+    {
+    public:
+        subrangestream_t(alloc_t* allocator, istream_t* inner, filehandle_t* parent, u64 offset, u64 length)
+            : istream_t(1)
+            , m_allocator(allocator)
+            , m_inner(inner)
+            , m_parent(parent)
+            , m_offset(offset)
+            , m_length(length)
+        {
+        }
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        // The parent can be shorter than the range, only the bytes that can be read are counted
+        virtual u64 getLength(filedevice_t* fd, filehandle_t* fh)
+        {
+            u64 const parent = m_inner->getLength(fd, m_parent);
+            if (parent <= m_offset)
+                return 0;
+            return ((parent - m_offset) < m_length) ? (parent - m_offset) : m_length;
+        }
+
+        virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length) {}
+        virtual void flush(filedevice_t* fd, filehandle_t* fh) { m_inner->flush(fd, m_parent); }
+
+        virtual s64 setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos)
+        {
+            s64 const old = current;
+            if ((caps & USE_SEEK) != 0)
+            {
+                if (pos < 0)
+                    pos = 0;
+                else if (pos > (s64)m_length)
+                    pos = (s64)m_length;
+                current = pos;
+            }
+            return old;
+        }
+
+        virtual void close(filedevice_t* fd, filehandle_t*& fh)
+        {
+            // Release our reference on the parent, the last one closes it, our own handle shares its OS handle
+            filesys_t::release_stream(m_inner, fd, m_parent);
+            fh->m_owner->release_filehandle(fh);
+
+            alloc_t* allocator = m_allocator;
+            allocator->destruct(this);
+        }
+
+        virtual s64 read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count)
+        {
+            count = clamp(pos, count);
+            if (count <= 0)
+                return 0;
+            s64       inner_pos = (s64)m_offset + pos;
+            s64 const n         = m_inner->read(fd, m_parent, caps, inner_pos, buffer, count);
+            if (n > 0)
+                pos += n;
+            return n;
+        }
+
+        virtual s64 write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count)
+        {
+            count = clamp(pos, count);
+            if (count <= 0)
+                return 0;
+            s64       inner_pos = (s64)m_offset + pos;
+            s64 const n         = m_inner->write(fd, m_parent, caps, inner_pos, buffer, count);
+            if (n > 0)
+                pos += n;
+            return n;
+        }
+
+    protected:
+        inline s64 clamp(s64 pos, s64 count) const
+        {
+            if (pos < 0 || pos >= (s64)m_length)
+                return 0;
+            s64 const available = (s64)m_length - pos;
+            return (count > available) ? available : count;
+        }
+
+        alloc_t*      m_allocator;
+        istream_t*    m_inner;
+        filehandle_t* m_parent;
+        u64           m_offset;
+        u64           m_length;
+    };
+
+    istream_t* create_subrange_stream(alloc_t* allocator, istream_t* inner, filehandle_t* parent, u64 offset, u64 length)
+    {
+        void* mem = allocator->allocate(sizeof(subrangestream_t), sizeof(void*));
+        return new (mem) subrangestream_t(allocator, inner, parent, offset, length);
+    }
+
+    stream_t xstream_subrange(stream_t& stream, u64 offset, u64 length) { return filesys_t::subrange(stream, offset, length); }
+
+}; // namespace xcore
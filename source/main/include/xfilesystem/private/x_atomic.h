@@ -0,0 +1,96 @@
+#ifndef __X_FILESYSTEM_ATOMIC_H__
+#define __X_FILESYSTEM_ATOMIC_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if defined(TARGET_PC)
+#include <intrin.h>
+#elif defined(TARGET_MAC)
+#include <sched.h>
+#endif
+
+// Storage class of a variable that every thread has its own copy of
+#if defined(TARGET_PC)
+#define X_THREAD_LOCAL __declspec(thread)
+#else
+#define X_THREAD_LOCAL __thread
+#endif
+
+namespace xcore
+{
+    //==============================================================================
+    // Minimal set of atomic operations used by the filesystem to share state
+    // between user threads and the IO thread (see doIO).
+    //==============================================================================
+    namespace xatomic
+    {
+#if defined(TARGET_PC)
+        // Returns the value that was in *ptr before the exchange
+        inline s32 cas(s32 volatile* ptr, s32 expected, s32 desired) { return (s32)_InterlockedCompareExchange((long volatile*)ptr, (long)desired, (long)expected); }
+        inline s32 incr(s32 volatile* ptr) { return (s32)_InterlockedIncrement((long volatile*)ptr); }
+        inline s32 decr(s32 volatile* ptr) { return (s32)_InterlockedDecrement((long volatile*)ptr); }
+        inline s32 load(s32 volatile const* ptr)
+        {
+            s32 const value = *ptr;
+            _ReadWriteBarrier();
+            return value;
+        }
+        inline void store(s32 volatile* ptr, s32 value) { _InterlockedExchange((long volatile*)ptr, (long)value); }
+        inline void pause() { _mm_pause(); }
+
+        // Returns the pointer that was in *ptr before the operation
+        inline void* casptr(void* volatile* ptr, void* expected, void* desired) { return _InterlockedCompareExchangePointer(ptr, desired, expected); }
+        inline void* xchgptr(void* volatile* ptr, void* value) { return _InterlockedExchangePointer(ptr, value); }
+#else
+        inline s32 cas(s32 volatile* ptr, s32 expected, s32 desired) { return __sync_val_compare_and_swap(ptr, expected, desired); }
+        inline s32 incr(s32 volatile* ptr) { return __sync_add_and_fetch(ptr, 1); }
+        inline s32 decr(s32 volatile* ptr) { return __sync_sub_and_fetch(ptr, 1); }
+        inline s32 load(s32 volatile const* ptr)
+        {
+            s32 const value = *ptr;
+            __sync_synchronize();
+            return value;
+        }
+        inline void store(s32 volatile* ptr, s32 value)
+        {
+            __sync_synchronize();
+            *ptr = value;
+            __sync_synchronize();
+        }
+        inline void pause() { sched_yield(); }
+
+        inline void* casptr(void* volatile* ptr, void* expected, void* desired) { return __sync_val_compare_and_swap(ptr, expected, desired); }
+        inline void* xchgptr(void* volatile* ptr, void* value)
+        {
+            void* current = *ptr;
+            while (true)
+            {
+                void* const previous = __sync_val_compare_and_swap(ptr, current, value);
+                if (previous == current)
+                    return previous;
+                current = previous;
+            }
+        }
+#endif
+
+        // A tiny spin lock, only to be used around very short critical sections
+        struct spinlock_t
+        {
+            inline spinlock_t() : m_lock(0) {}
+
+            inline void lock()
+            {
+                while (cas(&m_lock, 0, 1) != 0)
+                    pause();
+            }
+            inline void unlock() { store(&m_lock, 0); }
+
+            s32 volatile m_lock;
+        };
+
+    } // namespace xatomic
+};    // namespace xcore
+
+#endif // __X_FILESYSTEM_ATOMIC_H__
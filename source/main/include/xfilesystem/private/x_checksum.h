@@ -0,0 +1,37 @@
+#ifndef __X_FILESYSTEM_CHECKSUM_H__
+#define __X_FILESYSTEM_CHECKSUM_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xfilesystem/private/x_enumerations.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // checksum_t:
+    //     Incremental checksum, data can be fed in pieces of any size and the
+    //     digest is the same as when all data was given at once.
+    //==============================================================================
+    class checksum_t
+    {
+    public:
+        checksum_t(EChecksum algo = Checksum_CRC32C);
+
+        void reset(EChecksum algo);
+        void update(xbyte const* data, u64 size);
+        u64  digest() const;
+
+    protected:
+        EChecksum m_algo;
+        u32       m_crc;
+        u64       m_total;
+        u64       m_lanes[4];
+        xbyte     m_tail[32];
+        u32       m_tail_size;
+    };
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_CHECKSUM_H__
@@ -32,9 +32,10 @@ namespace xcore
         {
             MAX_FILE_ALIASES = 16,
             MAX_FILE_DEVICES = 48,
+            ALIAS_TABLE_SIZE  = 32,  ///< Power of two, at least twice MAX_FILE_ALIASES
+            DEVICE_TABLE_SIZE = 128, ///< Power of two, at least twice MAX_FILE_DEVICES
         };
         typedef runes_t      runes;
-        typedef utf32::rune  rune;
 
     public:
         devicemanager_t(filesystem_t::context_t* stralloc);
@@ -53,18 +54,26 @@ namespace xcore
         // Pass on the filepath or dirpath, e.g. 'c:\folder\subfolder\' or 'appdir:\data\texture.jpg'
 		bool has_device(const path_t& path);
         filedevice_t* find_device(const path_t& path, path_t& device_rootpath);
+        filedevice_t* find_device(const crunes_t& path, path_t& device_rootpath); // @path does not have to be normalized
 
+        // Resolution without building a path, nothing is allocated or copied. The system path is
+        // @prefix followed by @relative, e.g. 'd:\project\data\' and 'textures\a.png', @prefix
+        // points into the device manager and @relative into @path.
+        filedevice_t* find_device(const path_t& path, crunes_t& prefix, crunes_t& relative);
+
+        // Writes the system path into @syspath, which has to be of the same encoding as the paths
+        // (context_t::m_path_type). Returns nullptr when there is no device or @syspath is too small.
+        filedevice_t* find_device(const path_t& path, runes_t& syspath);
+
+        // The names are stored in the encoding of the paths (context_t::m_path_type) so that
+        // a lookup compares runes of the same type. A lookup compares the hash (path_t::hash)
+        // of a name first, the runes are only compared when the hashes are equal.
         struct alias_t
         {
-            inline alias_t()
-                : mAlias(mAliasRunes, mAliasRunes, mAliasRunes + (sizeof(mAliasRunes)/sizeof(mAliasRunes[0])) - 1)
-                , mTarget()
-                , mResolved()
-                , mDeviceIndex(-1)
-            {
-                mAliasRunes[(sizeof(mAliasRunes) / sizeof(mAliasRunes[0])) - 1] = '\0';
-            }
-            rune  mAliasRunes[16]; // 
+            inline alias_t() : mAliasHash(0), mAlias(), mTarget(), mResolved(), mDeviceIndex(-1) {}
+            void  init(s32 type);
+            u32   mAliasRunes[16]; // Storage of mAlias, 15 utf32 or 63 utf8 characters
+            u64   mAliasHash;
             runes mAlias;          // "data"
             runes mTarget;         // "appdir:\data\bin.pc\", "data:\file.txt" to "appdir:\data\bin.pc\file.txt"
             runes mResolved;       // "appdir:\data\bin.pc\" to "d:\project\data\bin.pc\"
@@ -79,14 +88,11 @@ namespace xcore
 
 		struct device_t
         {
-            inline device_t()
-                : mDevName(mDevNameRunes, mDevNameRunes, mDevNameRunes + (sizeof(mDevNameRunes) / sizeof(mDevNameRunes[0])) - 1)
-                , mDevice(nullptr)
-            {
-                mDevNameRunes[(sizeof(mDevNameRunes) / sizeof(mDevNameRunes[0])) - 1] = '\0';
-            }
-            rune         mDevNameRunes[16];
-            runes        mDevName;
+            inline device_t() : mDevNameHash(0), mDevName(), mDevice(nullptr) {}
+            void          init(s32 type);
+            u32           mDevNameRunes[16]; // Storage of mDevName
+            u64           mDevNameHash;
+            runes         mDevName;
             filedevice_t* mDevice;
         };
 
@@ -96,6 +102,16 @@ namespace xcore
         alias_t       mAliasList[MAX_FILE_ALIASES];
         s32           mNumDevices;
         device_t      mDeviceList[MAX_FILE_DEVICES];
+
+        // Open-addressing (linear probing) index of the names by hash, an entry is an index
+        // into mAliasList/mDeviceList or -1 when it is free. Rebuilt by resolve(), so a lookup
+        // costs the same no matter how many devices and aliases are registered.
+        void          build_index();
+        s32           lookup_alias(const crunes_t& name, u64 hash) const;
+        s32           lookup_device(const crunes_t& name, u64 hash) const;
+
+        s8            mAliasTable[ALIAS_TABLE_SIZE];
+        s8            mDeviceTable[DEVICE_TABLE_SIZE];
     };
 }; // namespace xcore
 
@@ -61,6 +61,14 @@ namespace xcore
 	{
 		FileOp_Sync,
 		FileOp_Async,
+		FileOp_Buffered,					///< Small writes are coalesced into buffers that are written to the device in the background, flush() waits for them
+		FileOp_Lazy,						///< Only with FileMode_Open, the file is opened on the first read or write and getLength() only reads the file information
+	};
+
+	enum EChecksum
+	{
+		Checksum_CRC32C,					///< CRC-32C (Castagnoli), uses the SSE4.2 crc32 instruction when the CPU has it
+		Checksum_XXH64,						///< xxHash64, seed 0
 	};
 
 	enum EError
@@ -47,6 +47,9 @@ namespace xcore
         virtual bool canWrite() const = 0;
         virtual bool canSeek() const = 0;
 
+        // Paths on a device that is not case sensitive are matched with their case-folded hash, see path_t::hash_folded
+        virtual bool isCaseSensitive() const { return true; }
+
         virtual bool getDeviceInfo(u64& totalSpace, u64& freeSpace) const = 0;
 
         virtual bool openFile(filepath_t const& szFilename, EFileMode mode, EFileAccess access, EFileOp op, void*& outHandle) = 0;
@@ -54,12 +57,27 @@ namespace xcore
         virtual bool writeFile(void* pHandle, u64 pos, void const* buffer, u64 count, u64& outNumBytesWritten) = 0;
         virtual bool closeFile(void* pHandle)                                                                  = 0;
 
+        // Copy between two files of this device without passing the data through user memory, devices that can do this
+        // override it. Returning false makes the caller fall back to reading and writing.
+        virtual bool copyFileRange(void* pSrcHandle, u64 srcPos, void* pDstHandle, u64 dstPos, u64 count, u64& outNumBytesCopied) { return false; }
+
         virtual bool createStream(filepath_t const& szFilename, bool boRead, bool boWrite, stream_t& strm) = 0;
         virtual bool closeStream(stream_t& strm)                                                           = 0;
 
         virtual bool setLengthOfFile(void* pHandle, u64 inLength)   = 0;
         virtual bool getLengthOfFile(void* pHandle, u64& outLength) = 0;
 
+        // Length of a file that is not open, devices that can get it from the file information override this
+        virtual bool getLengthOfFileByPath(filepath_t const& szFilename, u64& outLength)
+        {
+            void* handle = nullptr;
+            if (!openFile(szFilename, FileMode_Open, FileAccess_Read, FileOp_Sync, handle))
+                return false;
+            bool const result = getLengthOfFile(handle, outLength);
+            closeFile(handle);
+            return result;
+        }
+
         virtual bool setFileTime(filepath_t const& szFilename, filetimes_t const& times) = 0;
         virtual bool getFileTime(filepath_t const& szFilename, filetimes_t& outTimes)    = 0;
         virtual bool setFileAttr(filepath_t const& szFilename, fileattrs_t const& attr)  = 0;
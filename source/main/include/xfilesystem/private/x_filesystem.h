@@ -10,7 +10,9 @@
 #include "xbase/x_buffer.h"
 #include "xbase/x_runes.h"
 
+#include "xfilesystem/private/x_atomic.h"
 #include "xfilesystem/private/x_enumerations.h"
+#include "xfilesystem/private/x_istream.h"
 #include "xfilesystem/private/x_path.h"
 #include "xfilesystem/x_filesystem.h"
 
@@ -23,16 +25,39 @@ namespace xcore
     class devicemanager_t;
     class stream_t;
     class istream_t;
+    class ioqueue_t;
+    class copy_progress_t;
+    class io_thread_t;
+    class pathtable_t;
 
+    // A slot in the file handle table of filesys_t, m_id identifies the slot together with its generation
+    // (salt << 16 | index). The salt is changed every time the slot is released, an id that was taken
+    // before that does not match anymore.
+    // There can be more file handles than OS handles, an idle OS handle is closed and is opened again
+    // from m_device and m_path on the next access (see filesys_t::acquire_oshandle).
+    // The table of file handles is allocated up front, with the inline buffer of m_path a handle is about
+    // 580 bytes on a 64-bit target, so the default of 1024 handles (context_t::m_max_file_handles) is ~600 KB.
     struct filehandle_t
     {
         void*         m_handle;
         filesys_t*    m_owner;
-        s32           m_refcount;
-        s32           m_salt;
+        s32 volatile  m_refcount;
+        u32           m_salt;
+        u32           m_id;
         path_t        m_path;
+        filedevice_t* m_device;    // nullptr when the OS handle cannot be opened again (e.g. memory streams)
+        EFileAccess   m_access;
+        EFileOp       m_op;
+        s32           m_pins;      // Number of calls using m_handle at this moment, a pinned OS handle is not closed
+        s32           m_reopening;
+        u32           m_caps;        // Caps of the streams that share this handle
+        u64           m_path_hash;   // Folded when the device is not case sensitive
+        bool          m_shared;      // Registered in the shared table of filesys_t, see find_shared_filehandle
+        filehandle_t* m_shared_next;
         filehandle_t* m_prev;
         filehandle_t* m_next;
+        filehandle_t* m_lru_prev;
+        filehandle_t* m_lru_next;
     };
 
     class filesys_t
@@ -41,10 +66,19 @@ namespace xcore
         char                      m_slash;
         filesystem_t::context_t   m_context;
         devicemanager_t*          m_devman;
+        ioqueue_t*                m_ioqueue;
+        pathtable_t*              m_pathtable;
 
-        filehandle_t* m_filehandle_list_free;
-        filehandle_t* m_filehandle_list_active;
-        filehandle_t* m_filehandle_array;
+        filehandle_t*       m_filehandle_list_free;
+        filehandle_t*       m_filehandle_list_active;
+        filehandle_t*       m_filehandle_array;
+        u32                 m_filehandle_count;
+        filehandle_t*       m_oshandle_lru_head; // Most recently used
+        filehandle_t*       m_oshandle_lru_tail; // Least recently used, the first to be closed
+        u32                 m_oshandle_count;
+        filehandle_t**      m_shared_table;      // Read-only file handles by path hash
+        u32                 m_shared_table_mask;
+        xatomic::spinlock_t m_filehandle_lock;
 
         XCORE_CLASS_PLACEMENT_NEW_DELETE
 
@@ -60,6 +94,44 @@ namespace xcore
         static path_t const& get_path(filepath_t const& filepath);
         static filesys_t*    get_filesystem(dirpath_t const& dirpath);
         static filesys_t*    get_filesystem(filepath_t const& filepath);
+        static void          process_io(io_thread_t* io_thread);
+        static stream_t      decorate(stream_t& stream, create_decorator_fn create, u32 arg);
+        static stream_t      subrange(stream_t& stream, u64 offset, u64 length);
+        static u64           copy_stream(stream_t& src, stream_t& dst, u64 count, buffer_t& buffer, copy_progress_t* progress);
+        static alloc_t*      get_allocator(stream_t const& stream);
+        static u32           intern_path(path_t const& path);
+
+        // A reference on the stream implementation @impl that uses @fh, the last release closes @impl and,
+        // for an implementation that is shared (m_copies == 0), releases @fh. Returns true when @impl was closed.
+        static void          acquire_stream(istream_t* impl, filehandle_t* fh);
+        static bool          release_stream(istream_t* impl, filedevice_t* fd, filehandle_t* fh);
+        static void          interned_path(u32 pathid, path_t& path);
+
+        void          init_filehandles();
+        void          exit_filehandles();
+        filehandle_t* obtain_filehandle(); // nullptr when all m_max_file_handles handles are in use
+        void          release_filehandle(filehandle_t* fh);
+        filehandle_t* find_filehandle(u32 id); // nullptr when @id is stale
+
+        // OS handle of @fh for the duration of one IO call, opens it again when it was closed to stay
+        // within m_max_open_files. Every acquire has to be followed by a release.
+        void*         acquire_oshandle(filedevice_t* fd, filehandle_t* fh);
+        void          release_oshandle(filehandle_t* fh);
+        bool          get_length_without_oshandle(filedevice_t* fd, filehandle_t* fh, u64& length); // false when the OS handle is open or the device cannot tell
+        void          attach_oshandle(filehandle_t* fh, void* handle);
+        void*         detach_oshandle(filehandle_t* fh);
+
+        // Read-only opens of the same file share one file handle, every stream keeps its own position
+        filehandle_t* find_shared_filehandle(filedevice_t* fd, path_t const& path, u64 hash);
+        void          share_filehandle(filehandle_t* fh, u64 hash);
+
+    protected:
+        void          unshare_filehandle(filehandle_t* fh);
+        void          make_room_for_oshandle();
+        void          lru_remove(filehandle_t* fh);
+        void          lru_push(filehandle_t* fh);
+
+    public:
 
         // -----------------------------------------------------------
         bool register_device(const crunes_t& device_name, filedevice_t* device);
@@ -68,8 +140,12 @@ namespace xcore
         dirpath_t  dirpath(const char* str);
         filepath_t filepath(const crunes_t& str);
         dirpath_t  dirpath(const crunes_t& str);
+        filepath_t filepath(const path_literal_t& str);
+        dirpath_t  dirpath(const path_literal_t& str);
 
         stream_t   open(const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op);
+        stream_t   open(buffer_t const& buffer, EFileAccess access);
+        stream_t   open(alloc_t* arena, u64 capacity);
         void       close(stream_t&);
         bool       exists(fileinfo_t const&);
         bool       exists(dirinfo_t const&);
@@ -79,6 +155,18 @@ namespace xcore
         void       copy(fileinfo_t const& src, fileinfo_t const& dst);
         void       rm(fileinfo_t const&);
         void       rm(dirinfo_t const&);
+
+        filedevice_t* resolve(filepath_view const&, filepath_t& syspath);
+        filedevice_t* resolve(dirpath_view const&, dirpath_t& syspath);
+        filedevice_t* resolve(crunes_t const& path, runes_t& syspath);
+        stream_t      open(filepath_view const& filename, EFileMode mode, EFileAccess access, EFileOp op);
+        bool          exists(filepath_view const&);
+        bool          exists(dirpath_view const&);
+        s64           size(filepath_view const&);
+        bool          attrs(filepath_view const&, fileattrs_t&);
+        bool          times(filepath_view const&, filetimes_t&);
+        bool          syspath(filepath_view const&, runes_t& syspath);
+        bool          syspath(dirpath_view const&, runes_t& syspath);
     };
 
 }; // namespace xcore
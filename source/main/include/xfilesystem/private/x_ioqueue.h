@@ -0,0 +1,58 @@
+#ifndef __X_FILESYSTEM_IOQUEUE_H__
+#define __X_FILESYSTEM_IOQUEUE_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xfilesystem/private/x_atomic.h"
+
+namespace xcore
+{
+    class io_thread_t;
+
+    // A unit of work that is executed by the IO thread
+    class iojob_t
+    {
+    public:
+        inline iojob_t() : m_next(nullptr) {}
+
+        virtual void execute() = 0;
+
+    protected:
+        friend class ioqueue_t;
+        iojob_t* m_next;
+    };
+
+    //==============================================================================
+    // ioqueue_t:
+    //     FIFO of pending IO jobs, filled by any thread and drained by the IO
+    //     thread that the user hands to doIO(). When no IO thread is running the
+    //     jobs stay in the queue and can be taken back with remove(), so that
+    //     the owner can execute them on its own thread.
+    //==============================================================================
+    class ioqueue_t
+    {
+    public:
+        ioqueue_t();
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        void push(iojob_t* job);
+        bool remove(iojob_t* job);
+
+        // Blocks and executes jobs until io_thread->quit() is true
+        void process(io_thread_t* io_thread);
+
+    protected:
+        iojob_t* pop();
+
+        xatomic::spinlock_t m_lock;
+        iojob_t*            m_head;
+        iojob_t*            m_tail;
+        io_thread_t*        m_thread;
+    };
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_IOQUEUE_H__
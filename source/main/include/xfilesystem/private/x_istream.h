@@ -5,21 +5,77 @@
 #pragma once
 #endif
 
+#include "xfilesystem/private/x_enumerations.h"
+
 namespace xcore
 {
+    class alloc_t;
+    class buffer_t;
+    class ioqueue_t;
+    class filepath_t;
     struct filehandle_t;
     class filedevice_t;
 
+    enum ECaps
+    {
+        NONE      = 0x0000,
+        CAN_READ  = 0x0001,
+        CAN_SEEK  = 0x0002,
+        CAN_WRITE = 0x0004,
+        CAN_ASYNC = 0x0008,
+        USE_READ  = 0x1000,
+        USE_SEEK  = 0x2000,
+        USE_WRITE = 0x4000,
+        USE_ASYNC = 0x8000,
+    };
+
+    // An implementation is either shared by all streams (e.g. the file stream) and then @m_copies is 0 and
+    // the copies of a stream are counted by the file handle, or it belongs to one stream and is created with
+    // @copies = 1 to count the copies of that stream itself (see filesys_t::acquire_stream/release_stream).
     class istream_t
     {
     public:
+        inline istream_t(s32 copies = 0) : m_copies(copies) {}
+
+        s32 volatile m_copies;
+
         virtual u64  getLength(filedevice_t* fd, filehandle_t* fh) = 0;
         virtual void setLength(filedevice_t* fd, filehandle_t* fh, u64 length) = 0;
         virtual s64  setPos(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& current, s64 pos) = 0;
         virtual void close(filedevice_t* fd, filehandle_t*& fh) = 0;
+        virtual void flush(filedevice_t* fd, filehandle_t* fh) = 0;
         virtual s64 read(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, xbyte* buffer, s64 count) = 0;
         virtual s64 write(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, const xbyte* buffer, s64 count) = 0;
+
+        // Returns a pointer to @count bytes at @pos in the backing memory and advances @pos, nullptr if not supported or not enough data
+        virtual xbyte const* borrow(filedevice_t* fd, filehandle_t* fh, u32 caps, s64& pos, s64 count) { return nullptr; }
+
+        // Returns the running checksum of a checksum stream, 0 for any other stream
+        virtual u64 digest() const { return 0; }
     };
+
+    extern istream_t* get_filestream();
+    extern u32        filestream_caps(filedevice_t* fd, EFileAccess access, EFileOp op);
+    extern void*      open_filestream(filedevice_t* fd, const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op, u32& out_caps);
+
+    // Write-behind file stream, writes are coalesced into @buffer_count buffers of @buffer_size bytes that are written by the IO thread
+    extern istream_t* create_writebehind_stream(alloc_t* allocator, ioqueue_t* queue, u32 buffer_size, u32 buffer_count);
+
+    // Memory stream, either directly on top of @buffer (no copy, cannot grow) or on memory from @arena that grows when written to
+    extern istream_t* create_memstream(alloc_t* allocator, buffer_t const& buffer);
+    extern istream_t* create_memstream(alloc_t* allocator, alloc_t* arena, u64 capacity);
+
+    // View on [@offset, @offset + @length) of @inner, holds a reference on @inner which uses @parent as its file handle
+    extern istream_t* create_subrange_stream(alloc_t* allocator, istream_t* inner, filehandle_t* parent, u64 offset, u64 length);
+
+    // Decorators, they take over the reference on @inner and release it when they are closed
+    typedef istream_t* (*create_decorator_fn)(alloc_t* allocator, istream_t* inner, u32 arg);
+
+    // LZ4 compressed blocks of @block_size bytes with an index for seeking
+    extern istream_t* create_lz4_stream(alloc_t* allocator, istream_t* inner, u32 block_size);
+
+    // Checksum (@algo is an EChecksum) of all data that is read or written
+    extern istream_t* create_checksum_stream(alloc_t* allocator, istream_t* inner, u32 algo);
 };
 
 #endif
@@ -39,9 +39,38 @@ namespace xcore
     class filepath_t;
     class dirpath_t;
 
+    //==============================================================================
+    // path_t:
+    //     Short paths are stored in a buffer inside path_t, only paths that do
+    //     not fit are allocated with the string allocator of the context, or with
+    //     the path_arena of the thread when there is one. Any function that writes
+    //     to m_path has to use alloc() as the allocator. A path that is kept by the
+    //     library (see set_persistent) never uses the path_arena.
+    //
+    //     The levels of the path (the folders and the filename after the device)
+    //     are indexed by their start and end offset. Level, parent, filename and
+    //     extension queries are slices of m_path using this index. The index is
+    //     built on construction and again on the first query after m_path changed,
+    //     together with the case-sensitive and the case-folded hash of the path.
+    //
+    //     Moving a path takes over its allocated runes and level index, a path
+    //     that is stored inline is copied (no allocation either way). Copying a
+    //     path copies its level index and hashes, it is not normalized again.
+    //
+    //     The inline buffers make a path_t about 460 bytes on a 64-bit target
+    //     (SBO_SIZE, INDEX_INLINE levels and bookkeeping), keep that in mind for
+    //     arrays of paths such as the file handle table of filesys_t.
+    //==============================================================================
     class path_t
     {
     public:
+        enum
+        {
+            SBO_SIZE     = 256, ///< Bytes of inline storage for the runes of the path (including the terminator)
+            INDEX_INLINE = 16,  ///< Number of levels that are indexed without an allocation
+            MAX_LENGTH   = 0xFFFF, ///< Runes (utf32) or bytes (utf8) of a path that the level index can address
+        };
+
         filesystem_t::context_t* m_context;
         runes_t m_path;
 
@@ -49,6 +78,7 @@ namespace xcore
         path_t(filesystem_t::context_t* allocator);
         path_t(filesystem_t::context_t* allocator, const crunes_t& path);
         path_t(const path_t& path);
+        path_t(path_t&& path);
         path_t(const path_t& lhspath, const path_t& rhspath);
         ~path_t();
 
@@ -57,6 +87,9 @@ namespace xcore
         void set_filepath(runes_t& runes, filesystem_t::context_t* ctxt);
         void set_dirpath(runes_t& runes, filesystem_t::context_t* ctxt);
 
+        // Copies a path that is already normalized, the level index and the hashes are taken over when @index is not nullptr
+        void adopt(crunes_t const& normalized, u16 const* index, s32 levels, s32 ext, u64 hash, u64 hash_folded);
+
         void combine(const path_t& dirpath, const path_t& filepath);
         void copy_dirpath(runes_t& runes);
         void clear();
@@ -88,8 +121,13 @@ namespace xcore
 
         path_t& operator=(const runes_t&);
         path_t& operator=(const path_t&);
+        path_t& operator=(path_t&&);
         path_t& operator+=(const runes_t&);
 
+        // 64-bit hash of the path, hash_folded() is the same for paths that only differ in the case of ASCII letters
+        u64 hash() const;
+        u64 hash_folded() const;
+
         bool operator==(const path_t&) const;
         bool operator!=(const path_t&) const;
 
@@ -100,6 +138,60 @@ namespace xcore
         static void as_utf16(filepath_t const& fp, filepath_t& dst);
         static void as_utf16(dirpath_t const& dp, path_t& dst);
         static void as_utf16(dirpath_t const& dp, dirpath_t& dst);
+
+        runes_alloc_t* alloc() { return &m_alloc; }
+        bool           is_inline() const;
+
+        // For a path that the library keeps (e.g. the path of a file handle) and that can outlive the path_arena
+        // of the thread, its runes are moved out of the arena now and are always allocated with the string
+        // allocator of the context from now on, also when another path is moved into it.
+        void           set_persistent();
+
+        // Path runes are stored as utf32 or utf8, see filesystem_t::context_t::m_path_type
+        static s32     sizeof_rune(s32 type);
+        static runes_t make_runes(void* mem, s32 len, s32 cap, s32 type);
+
+        // Hash of any runes, equal to hash()/hash_folded() of a path_t that holds the same characters
+        static u64     hash(crunes_t const& str, bool folded);
+
+    protected:
+        // Hands out the inline buffer when the runes fit, otherwise forwards to the string allocator of the context
+        class sbo_alloc_t : public runes_alloc_t
+        {
+        public:
+            inline sbo_alloc_t(path_t* owner) : m_owner(owner), m_persistent(false) { m_arena[0] = m_arena[1] = nullptr; }
+            virtual runes_t allocate(s32 len, s32 cap, s32 type);
+            virtual void    deallocate(runes_t& slice);
+            bool            is_arena(void const* bos) const { return bos != nullptr && (bos == m_arena[0] || bos == m_arena[1]); }
+
+            path_t*     m_owner;
+            bool        m_persistent; // Never allocates from the path_arena of the thread
+            void const* m_arena[2];   // Runes that came from a path_arena (the runes of m_path and the ones that replace them),
+                                      // any other runes that are not inline are from the string allocator
+        };
+
+        void    take(path_t& path);
+        void    invalidate_index();
+        void    copy_index(path_t const& path);
+        void    update_index() const;
+        s32     length() const; // Number of runes (utf32) or bytes (utf8)
+        runes_t slice(s32 from, s32 to) const;
+        s32     level_begin(s32 level) const { return m_index[level * 2]; }
+        s32     level_end(s32 level) const { return m_index[level * 2 + 1]; }
+
+        sbo_alloc_t m_alloc;
+        u32         m_sbo[SBO_SIZE / sizeof(u32)];
+
+        // m_path.m_str/m_end at the time the index was built, a mismatch means that m_path was changed
+        mutable void const* m_index_str;
+        mutable void const* m_index_end;
+        mutable s32         m_levels; // -1 when the index has to be built
+        mutable s32         m_ext;    // Offset of the '.' of the extension of the last level, -1 when there is none
+        mutable u64         m_hash;
+        mutable u64         m_hash_folded;
+        mutable s32         m_index_cap;
+        mutable u16*        m_index;  // Begin and end offset of every level
+        u16                 m_index_inline[INDEX_INLINE * 2];
     };
 
 }; // namespace xcore
@@ -0,0 +1,79 @@
+#ifndef __X_FILESYSTEM_PATHTABLE_H__
+#define __X_FILESYSTEM_PATHTABLE_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xbase/x_allocator.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_atomic.h"
+#include "xfilesystem/x_filesystem.h"
+
+namespace xcore
+{
+    class path_t;
+
+    //==============================================================================
+    // pathtable_t:
+    //     Interns paths, every distinct path gets a stable 32-bit id. A path is
+    //     stored as a node that links to the id of its parent and to the id of
+    //     its last segment (name), the names are stored only once.
+    //
+    //     "Device:\Folder\File.ext" => node(node(node(0, "Device:"), "Folder"), "File.ext")
+    //
+    //     Id 0 is the empty path and the parent of every top level segment.
+    //     Ids are never reused, the table only grows.
+    //==============================================================================
+    class pathtable_t
+    {
+    public:
+        pathtable_t(filesystem_t::context_t* ctxt);
+        ~pathtable_t();
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        u32  intern(path_t const& path);                  // Id of @path, adds it and its parents when needed
+        u32  intern(u32 parent, crunes_t const& name);    // Id of the path @name in the directory @parent
+        u32  parent(u32 pathid);                          // Id of the parent directory, 0 for a top level path
+        u32  name(u32 pathid);                            // Id of the last segment of the path
+        void get_path(u32 pathid, path_t& path);          // Empty path when @pathid is not in the table
+
+    protected:
+        struct name_t
+        {
+            runes_t m_runes;
+            u32     m_hash;
+            u32     m_next; // Next name in the same bucket, 0 ends the chain
+        };
+
+        struct node_t
+        {
+            u32 m_parent;
+            u32 m_name;
+            u32 m_hash;
+            u32 m_next; // Next node in the same bucket, 0 ends the chain
+        };
+
+        u32  find_or_add_name(crunes_t const& name);
+        u32  find_or_add_node(u32 parent, u32 name);
+        void build_path(u32 pathid, path_t& path);
+
+        filesystem_t::context_t* m_context;
+        name_t*                  m_names;
+        u32                      m_names_count;
+        u32                      m_names_cap;
+        u32*                     m_names_buckets;
+        u32                      m_names_mask;
+        node_t*                  m_nodes;
+        u32                      m_nodes_count;
+        u32                      m_nodes_cap;
+        u32*                     m_nodes_buckets;
+        u32                      m_nodes_mask;
+        xatomic::spinlock_t      m_lock;
+    };
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_PATHTABLE_H__
@@ -0,0 +1,68 @@
+#ifndef __X_FILESYSTEM_STRALLOC_H__
+#define __X_FILESYSTEM_STRALLOC_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xbase/x_allocator.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_atomic.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // stralloc_t:
+    //     The string allocator of the filesystem (context_t::m_stralloc). Rune
+    //     buffers come in size classes from a cache that every thread has for
+    //     itself, so threads that create paths do not contend on the allocator.
+    //     Only a cache that ran out of buffers of a size class goes to the
+    //     allocator, large buffers are not cached.
+    //
+    //     A buffer that is freed by another thread than the one that allocated it
+    //     is pushed on the remote list of the cache it came from. The owning
+    //     thread takes the whole list back at once when it runs out of buffers.
+    //     The remote list is capped, so a cache of a thread that has exited
+    //     holds a bounded number of buffers until the allocator is destroyed.
+    //     A thread has one cache per allocator, also after its slot was taken.
+    //==============================================================================
+    class stralloc_t : public runes_alloc_t
+    {
+    public:
+        enum
+        {
+            NUM_CLASSES    = 7,  ///< 64, 128, 256, ... 4096 bytes of runes
+            MIN_CLASS_SIZE = 64,
+            MAX_CACHED     = 64, ///< Free buffers per size class that a thread keeps
+            THREAD_CACHES  = 4,  ///< Allocators for which a thread keeps its cache at the same time
+            MAX_REMOTE     = 256, ///< Buffers freed by other threads that wait for a cache, more go back to the allocator
+        };
+
+        stralloc_t(alloc_t* allocator, s32 type);
+        virtual ~stralloc_t();
+
+        XCORE_CLASS_PLACEMENT_NEW_DELETE
+
+        // Path runes are allocated in the encoding that the filesystem is configured with (@type is ignored)
+        virtual runes_t allocate(s32 len, s32 cap, s32 type);
+        virtual void    deallocate(runes_t& slice);
+
+    protected:
+        struct buffer_t;
+        struct cache_t;
+
+        cache_t* get_cache();
+        void     reclaim(cache_t* cache);
+        void     release(cache_t* cache, buffer_t* buffer);
+
+        alloc_t*            m_allocator;
+        s32                 m_type;
+        u32                 m_generation; // Tells the thread caches of this allocator apart from the ones of other allocators
+        cache_t*            m_caches;     // Caches of all threads, they are freed with the allocator
+        xatomic::spinlock_t m_lock;       // Guards m_caches
+    };
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_STRALLOC_H__
@@ -28,6 +28,7 @@ namespace xcore
     public:
         dirinfo_t();
         dirinfo_t(const dirinfo_t& dirinfo);
+        dirinfo_t(dirinfo_t&& dirinfo);
 
         explicit dirinfo_t(const dirpath_t& dir);
 
@@ -53,6 +54,7 @@ namespace xcore
         bool            setAttrs(fileattrs_t attrs);
 
         dirinfo_t& operator=(const dirinfo_t&);
+        dirinfo_t& operator=(dirinfo_t&&);
         dirinfo_t& operator=(const dirpath_t&);
         bool      operator==(const dirpath_t&) const;
         bool      operator!=(const dirpath_t&) const;
@@ -43,6 +43,8 @@ namespace xcore
     public:
         dirpath_t();
         dirpath_t(const dirpath_t& dir);
+        dirpath_t(dirpath_t&& dir);
+        explicit dirpath_t(u32 pathid); // Path that was interned with filesystem_t::intern
         dirpath_t(const dirpath_t& rootdir, const dirpath_t& subdir);
         ~dirpath_t();
 
@@ -71,7 +73,11 @@ namespace xcore
 
         void toString(runes_t& dst) const;
 
+        u64  hash() const;        // Cached, see path_t::hash
+        u64  hash_folded() const; // Same for paths that only differ in the case of ASCII letters
+
         dirpath_t& operator=(const dirpath_t&);
+        dirpath_t& operator=(dirpath_t&&);
         dirpath_t& operator=(const filepath_t&);
         dirpath_t& operator+=(const dirpath_t&);
         filepath_t operator+=(const filepath_t&);
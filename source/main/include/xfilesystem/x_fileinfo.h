@@ -36,6 +36,7 @@ namespace xcore
     public:
         fileinfo_t();
         fileinfo_t(const fileinfo_t& fileinfo);
+        fileinfo_t(fileinfo_t&& fileinfo);
         fileinfo_t(const filepath_t& filename);
 
         u64  getLength() const;
@@ -85,6 +86,7 @@ namespace xcore
         bool move_to(const filepath_t& toFilename, bool overwrite);
 
         fileinfo_t& operator=(const fileinfo_t&);
+        fileinfo_t& operator=(fileinfo_t&&);
         fileinfo_t& operator=(const filepath_t&);
         bool        operator==(const fileinfo_t&) const;
         bool        operator!=(const fileinfo_t&) const;
@@ -115,6 +117,9 @@ namespace xcore
         static bool sSetAttrs(const filepath_t& filename, const fileattrs_t& fattrs);
         static bool sGetAttrs(const filepath_t& filename, fileattrs_t& fattrs);
 
+        static u64 sChecksum(const filepath_t& filename, EChecksum algo);
+        static u64 sChecksum(const filepath_t& filename, EChecksum algo, buffer_t& buffer);
+
         static bool sCopy(const filepath_t& sourceFilename, const filepath_t& destFilename, bool overwrite = true);
         static bool sMove(const filepath_t& sourceFilename, const filepath_t& destFilename, bool overwrite = true);
     };
@@ -36,6 +36,8 @@ namespace xcore
     public:
         filepath_t();
         filepath_t(const filepath_t& filepath);
+        filepath_t(filepath_t&& filepath);
+        explicit filepath_t(u32 pathid); // Path that was interned with filesystem_t::intern
         explicit filepath_t(const dirpath_t& dir, const filepath_t& filename);
         ~filepath_t();
 
@@ -55,7 +57,11 @@ namespace xcore
 
         void       toString(runes_t& dst) const;
 
+        u64        hash() const;        // Cached, see path_t::hash
+        u64        hash_folded() const; // Same for paths that only differ in the case of ASCII letters
+
         filepath_t& operator=(const filepath_t&);
+        filepath_t& operator=(filepath_t&&);
         bool       operator==(const filepath_t&) const;
         bool       operator!=(const filepath_t&) const;
     };
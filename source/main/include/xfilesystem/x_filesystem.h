@@ -22,6 +22,11 @@ namespace xcore
     class fileinfo_t;
     class dirpath_t;
     class dirinfo_t;
+    class filepath_view;
+    class dirpath_view;
+    class fileattrs_t;
+    class filetimes_t;
+    struct path_literal_t;
     class filesys_t;
     class filedevice_t;
 
@@ -30,9 +35,13 @@ namespace xcore
     public:
         struct context_t
         {
-            inline context_t() : m_max_open_files(32), m_default_slash('/'), m_allocator(nullptr), m_stralloc(nullptr) {}
-            u32            m_max_open_files;
+            inline context_t() : m_max_open_files(32), m_max_file_handles(1024), m_write_buffer_size(64 * 1024), m_write_buffer_count(4), m_default_slash('/'), m_path_type(utf32::TYPE), m_allocator(nullptr), m_stralloc(nullptr) {}
+            u32            m_max_open_files;     // Maximum number of OS file handles, idle ones are closed and opened again when needed
+            u32            m_max_file_handles;   // Maximum number of open streams
+            u32            m_write_buffer_size;  // Size of one write-behind buffer (FileOp_Buffered)
+            u32            m_write_buffer_count; // Number of write-behind buffers per stream (FileOp_Buffered)
             char           m_default_slash;
+            s32            m_path_type;          // Encoding of the runes of a path, utf32::TYPE or utf8::TYPE (1 byte per ASCII character)
             filesys_t*     m_owner;
             alloc_t*       m_allocator;
             runes_alloc_t* m_stralloc;
@@ -47,8 +56,19 @@ namespace xcore
         static dirpath_t  dirpath(const char* str);
         static filepath_t filepath(const crunes_t& str);
         static dirpath_t  dirpath(const crunes_t& str);
+        static filepath_t filepath(const path_literal_t& str); // See x_pathliteral.h, the path is not parsed again
+        static dirpath_t  dirpath(const path_literal_t& str);
+
+        // Interned paths, every distinct (normalized) path has a stable 32-bit id. Equal paths have
+        // equal ids, so comparing and hashing interned paths is an integer operation.
+        // filepath_t(pathid) and dirpath_t(pathid) give back the path.
+        static u32 intern(const filepath_t& path);
+        static u32 intern(const dirpath_t& path);
+        static u32 parent(u32 pathid); // 0 when the path has no parent
 
         static stream_t    open(const filepath_t& filename, EFileMode mode, EFileAccess access, EFileOp op);
+        static stream_t    open(buffer_t const& buffer, EFileAccess access);  // Stream over @buffer, nothing is copied
+        static stream_t    open(alloc_t* arena, u64 capacity);               // Growing stream in memory obtained from @arena
         static void        close(stream_t&);
         static fileinfo_t  info(filepath_t const& path);
         static dirinfo_t   info(dirpath_t const& path);
@@ -61,6 +81,21 @@ namespace xcore
         static void        rm(fileinfo_t const&);
         static void        rm(dirinfo_t const&);
 
+        // Read-only queries on a path string (see x_pathview.h), nothing is allocated for a path that fits
+        // the inline buffer of path_t. size() returns -1 when the file cannot be found.
+        static stream_t    open(filepath_view const& filename, EFileMode mode, EFileAccess access, EFileOp op);
+        static bool        exists(filepath_view const&);
+        static bool        exists(dirpath_view const&);
+        static s64         size(filepath_view const&);
+        static bool        attrs(filepath_view const&, fileattrs_t&);
+        static bool        times(filepath_view const&, filetimes_t&);
+
+        // Writes the system path (aliases and device resolved) into @syspath, a fixed buffer of the caller of the
+        // type context_t::m_path_type. Nothing is allocated for a path that fits the inline buffer of path_t.
+        // Returns false when the device is unknown or @syspath is too small.
+        static bool        syspath(filepath_view const&, runes_t& syspath);
+        static bool        syspath(dirpath_view const&, runes_t& syspath);
+
     protected:
         friend class filesys_t;
         static filesys_t* mImpl;
@@ -0,0 +1,65 @@
+#ifndef __X_FILESYSTEM_PATHARENA_H__
+#define __X_FILESYSTEM_PATHARENA_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xbase/x_allocator.h"
+#include "xbase/x_runes.h"
+
+namespace xcore
+{
+    //==============================================================================
+    // path_arena:
+    //     Bump allocator for the runes of paths. While a path_arena is alive, the
+    //     paths that the same thread creates and that do not fit the inline buffer
+    //     of path_t take their runes from the arena instead of from the string
+    //     allocator of the filesystem. Everything is released at once when the
+    //     arena is destroyed. Arenas can be nested, the innermost one is used.
+    //
+    //     Paths that were created while the arena was active must not be used after
+    //     it is gone. Destroying such a path later, or on another thread, is safe:
+    //     a path remembers that its runes came from an arena and does not give
+    //     them to the string allocator.
+    //
+    //     {
+    //         path_arena arena(allocator);
+    //         ... scan a directory tree, resolve a batch of paths ...
+    //     }
+    //==============================================================================
+    class path_arena : public runes_alloc_t
+    {
+    public:
+        path_arena(alloc_t* allocator, u32 block_size = 64 * 1024);
+        virtual ~path_arena();
+
+        virtual runes_t allocate(s32 len, s32 cap, s32 type);
+        virtual void    deallocate(runes_t& slice); // Only the last allocation is given back, the rest waits for the arena to go
+
+        bool owns(void const* ptr) const;
+        void reset(); // Releases all runes and keeps the first block
+
+        static path_arena* current();                   // Innermost arena of the calling thread, nullptr when there is none
+        static bool        release(runes_t& slice);     // True when one of the arenas of the calling thread owns @slice
+        static bool        contains(void const* ptr);   // True when one of the arenas of the calling thread owns @ptr
+
+    protected:
+        struct block_t
+        {
+            block_t* m_next;
+            u32      m_size; // Bytes of data that follow the header
+            u32      m_used;
+        };
+
+        block_t* new_block(u32 size);
+
+        alloc_t*    m_allocator;
+        u32         m_block_size;
+        block_t*    m_blocks; // Current block first
+        path_arena* m_outer;  // Arena that was active when this one was created
+    };
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_PATHARENA_H__
@@ -0,0 +1,196 @@
+#ifndef __X_FILESYSTEM_PATHLITERAL_H__
+#define __X_FILESYSTEM_PATHLITERAL_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xbase/x_debug.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/x_pathview.h"
+
+namespace xcore
+{
+    // What filesystem_t::filepath and filesystem_t::dirpath need to build a path from a path literal
+    struct path_literal_t
+    {
+        const char* m_str; // Normalized, utf-8
+        s32         m_len;
+        s32         m_levels;
+        s32         m_ext;   // Offset of the '.' of the extension of the last level, -1 when there is none
+        u16 const*  m_index; // Begin and end offset of every level, nullptr when the offsets are not rune offsets
+        u64         m_hash;
+        u64         m_hash_folded;
+    };
+
+#if (__cplusplus >= 201402L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+
+    // Not constexpr on purpose, a path literal that is not valid does not compile
+    inline void path_literal_is_invalid() { ASSERTS(false, "invalid path literal"); }
+
+    //==============================================================================
+    // path_literal:
+    //     A path that is normalized, validated, split into the device and its
+    //     levels and hashed by the compiler (this needs C++14 constexpr). The
+    //     result is the same as that of path_t, so building a filepath_t or a
+    //     dirpath_t from it only copies the runes and a view costs nothing.
+    //
+    //     static constexpr auto sConfig = XPATH_LITERAL("appdir:/data/config.bin");
+    //
+    //     filepath_t fp = filesystem_t::filepath(sConfig);   // "appdir:\data\config.bin"
+    //     if (filesystem_t::exists(sConfig.view())) ...
+    //==============================================================================
+    template <s32 N> class path_literal
+    {
+    public:
+        constexpr path_literal(const char (&str)[N])
+            : m_str{}
+            , m_len(0)
+            , m_device(0)
+            , m_levels(0)
+            , m_ext(-1)
+            , m_index{}
+            , m_hash(0)
+            , m_hash_folded(0)
+            , m_ascii(true)
+        {
+            // Same rules as the normalization of path_t: native slashes, no repeated separators, no separator
+            // at the start and the end, '.' and '..' resolved, a '..' directly below the device is dropped and
+            // a '..' does not remove another '..'.
+            bool valid = (N > 1);
+            s32  w     = 0;
+            s32  root  = 0;
+            s32  r     = 0;
+            while (r < (N - 1))
+            {
+                if (str[r] == '\\' || str[r] == '/')
+                {
+                    ++r;
+                    continue;
+                }
+
+                s32 const seg = r;
+                for (; r < (N - 1) && str[r] != '\\' && str[r] != '/'; ++r)
+                {
+                    u8 const c = (u8)str[r];
+                    if (c < 32 || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|')
+                        valid = false;
+                    if (c == ':' && (w != 0 || !(r + 1 == (N - 1) || str[r + 1] == '\\' || str[r + 1] == '/')))
+                        valid = false;
+                    if (c >= 0x80)
+                        m_ascii = false;
+                }
+
+                s32 const n = r - seg;
+                if (n == 1 && str[seg] == '.')
+                    continue;
+                if (n == 2 && str[seg] == '.' && str[seg + 1] == '.' && w == root && root > 0)
+                    continue;
+                if (n == 2 && str[seg] == '.' && str[seg + 1] == '.' && w > root)
+                {
+                    s32 prev = w;
+                    while (prev > root && m_str[prev - 1] != '\\')
+                        --prev;
+                    if (!((w - prev) == 2 && m_str[prev] == '.' && m_str[prev + 1] == '.'))
+                    {
+                        w = (prev > root) ? (prev - 1) : root;
+                        continue;
+                    }
+                }
+
+                bool const first = (w == 0);
+                if (!first)
+                    m_str[w++] = '\\';
+                for (s32 i = 0; i < n; ++i)
+                    m_str[w + i] = str[seg + i];
+                w += n;
+                if (first && str[seg + n - 1] == ':')
+                    root = w;
+            }
+            m_len    = w;
+            m_str[w] = '\0';
+            if (w == 0)
+                valid = false;
+
+            // The levels follow 'Device:\', a device on its own counts as a level just like it does for path_t
+            m_device = (root > 0 && root < w) ? (root + 1) : 0;
+            for (s32 i = m_device; i < w;)
+            {
+                s32 const begin = i;
+                m_ext           = -1;
+                for (; i < w && m_str[i] != '\\'; ++i)
+                {
+                    if (m_str[i] == '.')
+                        m_ext = i;
+                }
+                m_index[m_levels * 2]     = (u16)begin;
+                m_index[m_levels * 2 + 1] = (u16)i;
+                m_levels++;
+                ++i;
+            }
+
+            // FNV-1a (64-bit) over the code points, the same as path_t::hash() and path_t::hash_folded()
+            m_hash        = 0xCBF29CE484222325ULL;
+            m_hash_folded = 0xCBF29CE484222325ULL;
+            for (s32 i = 0; i < w;)
+            {
+                u32 c = (u32)(u8)m_str[i++];
+                s32 n = 0;
+                if (c >= 0xF0)
+                {
+                    c &= 0x07;
+                    n = 3;
+                }
+                else if (c >= 0xE0)
+                {
+                    c &= 0x0F;
+                    n = 2;
+                }
+                else if (c >= 0xC0)
+                {
+                    c &= 0x1F;
+                    n = 1;
+                }
+                for (; n > 0 && i < w; --n)
+                    c = (c << 6) | ((u32)(u8)m_str[i++] & 0x3F);
+                u32 const l   = (c >= 'A' && c <= 'Z') ? (c + ('a' - 'A')) : c;
+                m_hash        = (m_hash ^ c) * 0x100000001B3ULL;
+                m_hash_folded = (m_hash_folded ^ l) * 0x100000001B3ULL;
+            }
+
+            if (!valid)
+                path_literal_is_invalid();
+        }
+
+        crunes_t       runes() const { return crunes_t((utf8::pcrune)m_str, (utf8::pcrune)(m_str + m_len)); }
+        filepath_view  view() const { return filepath_view(runes()); }
+        dirpath_view   dirview() const { return dirpath_view(runes()); }
+        path_literal_t desc() const
+        {
+            // Level offsets are byte offsets, with non-ASCII characters they are not the offsets of utf32 runes
+            path_literal_t d = {m_str, m_len, m_levels, m_ext, m_ascii ? m_index : nullptr, m_hash, m_hash_folded};
+            return d;
+        }
+        operator path_literal_t() const { return desc(); }
+
+        char m_str[N];
+        s32  m_len;
+        s32  m_device; // Length of the 'Device:\' part, 0 for a relative path
+        s32  m_levels;
+        s32  m_ext;
+        u16  m_index[N + 1];
+        u64  m_hash;
+        u64  m_hash_folded;
+        bool m_ascii;
+    };
+
+    template <s32 N> constexpr path_literal<N> make_path_literal(const char (&str)[N]) { return path_literal<N>(str); }
+
+#define XPATH_LITERAL(str) xcore::make_path_literal(str)
+
+#endif
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_PATHLITERAL_H__
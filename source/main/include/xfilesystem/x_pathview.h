@@ -0,0 +1,55 @@
+#ifndef __X_FILESYSTEM_PATHVIEW_H__
+#define __X_FILESYSTEM_PATHVIEW_H__
+#include "xbase/x_target.h"
+#ifdef USE_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "xbase/x_debug.h"
+#include "xbase/x_runes.h"
+
+namespace xcore
+{
+    class filepath_t;
+    class dirpath_t;
+
+    //==============================================================================
+    // filepath_view / dirpath_view:
+    //     Non-owning view of a path string, nothing is copied or allocated. The
+    //     string has to stay alive as long as the view is used.
+    //     A view is only validated, it is normalized when it is resolved and the
+    //     resolved path is stored inline (see path_t) unless it is very long.
+    //
+    //     if (filesystem_t::exists(filepath_view("appdir:\\data\\config.bin")))
+    //==============================================================================
+    class filepath_view
+    {
+    public:
+        inline filepath_view(const char* str) : m_path(str) {}
+        inline filepath_view(crunes_t const& str) : m_path(str) {}
+        explicit filepath_view(filepath_t const& filepath);
+
+        bool isEmpty() const { return m_path.is_empty(); }
+        bool isValid() const; // Not empty, no wildcards or reserved characters, ':' only after the device name
+        bool isRooted() const;
+
+        crunes_t m_path;
+    };
+
+    class dirpath_view
+    {
+    public:
+        inline dirpath_view(const char* str) : m_path(str) {}
+        inline dirpath_view(crunes_t const& str) : m_path(str) {}
+        explicit dirpath_view(dirpath_t const& dirpath);
+
+        bool isEmpty() const { return m_path.is_empty(); }
+        bool isValid() const;
+        bool isRooted() const;
+
+        crunes_t m_path;
+    };
+
+}; // namespace xcore
+
+#endif // __X_FILESYSTEM_PATHVIEW_H__
@@ -7,6 +7,9 @@
 
 #include "xbase/x_debug.h"
 #include "xbase/x_buffer.h"
+#include "xbase/x_runes.h"
+
+#include "xfilesystem/private/x_enumerations.h"
 
 namespace xcore
 {
@@ -14,8 +17,35 @@ namespace xcore
     struct filehandle_t;
     class filedevice_t;
 
+    class stream_t;
+
+    ///< reader_t and writer_t as handed out by stream_t::get_reader() and stream_t::get_writer().
+    ///< Every call is forwarded as one block to the stream implementation, the position of the stream is advanced.
+    class stream_reader_t : public reader_t
+    {
+    public:
+        inline stream_reader_t() : m_stream(nullptr) {}
+        virtual u64 read(xbyte*, u64);
+
+    protected:
+        friend class stream_t;
+        stream_t* m_stream;
+    };
+
+    class stream_writer_t : public writer_t
+    {
+    public:
+        inline stream_writer_t() : m_stream(nullptr) {}
+        virtual u64 write(xbyte const*, u64);
+
+    protected:
+        friend class stream_t;
+        stream_t* m_stream;
+    };
+
     ///< stream_t object
     ///< The main interface of a stream object, user deals with this object most of the time.
+    ///< Copies share the underlying file handle, the file is closed when the last copy is closed.
     class stream_t
     {
     public:
@@ -41,6 +71,13 @@ namespace xcore
         s64 read(xbyte*, s64);
         s64 write(xbyte const*, s64);
 
+        // Returns a pointer to the next @count bytes without copying them and advances the position.
+        // Only memory streams support this, returns nullptr when not supported or when less than @count bytes are available.
+        xbyte const* borrow(s64 count);
+
+        // Running checksum of the data that passed through a checksum stream (see xstream_checksum), 0 for other streams.
+        u64 digest() const;
+
         reader_t* get_reader();
         writer_t* get_writer();
 
@@ -51,16 +88,71 @@ namespace xcore
 
         filedevice_t* m_filedevice;
         filehandle_t* m_filehandle;
+        u32 m_fhid;             ///< Id of m_filehandle when it was handed to this stream, see filesys_t::find_filehandle
         istream_t* m_pimpl;
-        u64 m_offset;
+        s64 m_offset;
+        mutable s64 m_length;   ///< Cached length of the stream, -1 when unknown
         u32 m_caps;
+        stream_reader_t m_reader;
+        stream_writer_t m_writer;
 
         friend class filesystem_t;
 		friend class filesys_t;
         friend class stream_t;
+        friend class stream_reader_t;
+        friend class stream_writer_t;
+    };
+
+    ///< Splits the data of a reader (e.g. stream_t::get_reader()) into records that end with a delimiter.
+    ///< The buffer is refilled in large blocks and the returned records are views into the buffer, they
+    ///< stay valid until the next call to next(). A record that is longer than the buffer is returned in
+    ///< pieces of the buffer size. The delimiter is not part of the record, the last record does not need one.
+    class record_reader_t
+    {
+    public:
+        record_reader_t(reader_t* reader, buffer_t& buffer, char delimiter = '\n');
+
+        bool next(crunes_t& record);
+
+    protected:
+        bool refill();
+
+        reader_t* m_reader;
+        xbyte*    m_data;
+        u64       m_size;
+        u64       m_begin;      ///< Start of the next record
+        u64       m_end;        ///< End of the valid data in the buffer
+        u64       m_scanned;    ///< Position from where to continue searching for the delimiter
+        bool      m_eof;
+        char      m_delimiter;
+    };
+
+    ///< Receives the progress of xstream_copy, called after every block that has been written
+    class copy_progress_t
+    {
+    public:
+        virtual void progress(u64 copied, u64 total) = 0;
     };
 
+    ///< Copies from the current position of @src to the current position of @dst, at most @count bytes.
+    ///< The buffer is split in two, the write of one half is done by the IO thread while the other half is read.
+    ///< When both streams are plain files on the same device the device is asked to do the copy.
+    ///< Returns the number of bytes copied.
     void xstream_copy(stream_t& src, stream_t& dst, buffer_t& buffer);
+    u64  xstream_copy(stream_t& src, stream_t& dst, u64 count, buffer_t& buffer, copy_progress_t* progress = nullptr);
+    u64  xstream_copy(stream_t& src, stream_t& dst, u64 count, copy_progress_t* progress = nullptr);
+
+    // Stores the data of @stream as LZ4 compressed blocks, an empty stream is written, otherwise it is read.
+    // @stream is taken over by the returned stream and is closed when the returned stream is closed.
+    stream_t xstream_lz4(stream_t& stream, u32 block_size = 64 * 1024);
+
+    // Computes a checksum over all data that is read from or written to @stream, see stream_t::digest().
+    // @stream is taken over by the returned stream and is closed when the returned stream is closed.
+    stream_t xstream_checksum(stream_t& stream, EChecksum algo);
+
+    // Returns a stream on the range [@offset, @offset + @length) of @stream, positions are relative to @offset.
+    // The range shares the file handle of @stream, the file stays open until @stream and all its ranges are closed.
+    stream_t xstream_subrange(stream_t& stream, u64 offset, u64 length);
 
 }; // namespace xcore
 
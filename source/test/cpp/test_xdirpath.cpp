@@ -40,6 +40,34 @@ UNITTEST_SUITE_BEGIN(dirpath)
 			dirpath_t dirpath = filesystem_t::dirpath("C:\\the\\name\\is\\johhnywalker");
 			CHECK_EQUAL(false, dirpath.isEmpty());
 		}
+
+		UNITTEST_TEST(levels)
+		{
+			dirpath_t dirpath = filesystem_t::dirpath("C:\\the\\name\\is\\johhnywalker");
+			CHECK_EQUAL(4, dirpath.getLevels());
+			for (s32 i = 0; i < 4; ++i)
+			{
+				dirpath_t level = filesystem_t::dirpath("");
+				CHECK_TRUE(dirpath.getLevel(i, level));
+				CHECK_TRUE(level == filesystem_t::dirpath(sFolders[i]));
+			}
+			dirpath_t level = filesystem_t::dirpath("");
+			CHECK_FALSE(dirpath.getLevel(4, level));
+
+			dirpath_t parent = filesystem_t::dirpath("C:\\the\\name");
+			CHECK_EQUAL(2, dirpath.getLevelOf(parent));
+			CHECK_EQUAL(0, dirpath.getLevelOf(dirpath));
+			CHECK_EQUAL(-1, parent.getLevelOf(dirpath));
+			dirpath_t other = filesystem_t::dirpath("C:\\the\\names");
+			CHECK_EQUAL(-1, dirpath.getLevelOf(other));
+
+			dirpath_t head = filesystem_t::dirpath("");
+			dirpath_t tail = filesystem_t::dirpath("");
+			CHECK_TRUE(dirpath.split(2, head, tail));
+			CHECK_TRUE(tail == filesystem_t::dirpath("is\\johhnywalker"));
+			CHECK_EQUAL(2, head.getLevels());
+			CHECK_EQUAL(0, head.getLevelOf(parent));
+		}
 	}
 }
 UNITTEST_SUITE_END
@@ -6,10 +6,14 @@
 
 #include "xunittest/xunittest.h"
 
+#include "xfilesystem/private/x_devicemanager.h"
 #include "xfilesystem/private/x_filedevice.h"
+#include "xfilesystem/private/x_path.h"
+#include "xfilesystem/private/x_stralloc.h"
 #include "xfilesystem/x_enumerator.h"
 #include "xfilesystem/x_filesystem.h"
 #include "xfilesystem/x_filepath.h"
+#include "xfilesystem/x_pathview.h"
 #include "xfilesystem/x_dirpath.h"
 #include "xfilesystem/x_dirinfo.h"
 #include "xfilesystem/x_fileinfo.h"
@@ -1103,6 +1107,63 @@ UNITTEST_SUITE_BEGIN(xfiledevice_register)
 			fileinfo_t fi(fp);
 			CHECK_EQUAL(true, fi.exists());
 		}
+
+		UNITTEST_TEST(syspath)
+		{
+			runez_t<utf32::rune, 64> syspath;
+			CHECK_TRUE(filesystem_t::syspath(filepath_view("TEST:/textfiles/docs/tech.txt"), syspath));
+			CHECK_EQUAL(0, compare(syspath, crunes_t("TEST:\\textfiles\\docs\\tech.txt")));
+			CHECK_FALSE(filesystem_t::syspath(dirpath_view("nodevice:\\textfiles"), syspath));
+		}
+
+		UNITTEST_TEST(device_lookup)
+		{
+			filesystem_t::context_t ctxt;
+			ctxt.m_allocator = gTestAllocator;
+			stralloc_t stralloc(gTestAllocator, ctxt.m_path_type);
+			ctxt.m_stralloc = &stralloc;
+
+			// Enough devices for the hash index to have collisions
+			devicemanager_t devman(&ctxt);
+			char name[] = "D00:\\";
+			for (s32 i = 0; i < 40; ++i)
+			{
+				name[1] = (char)('0' + (i / 10));
+				name[2] = (char)('0' + (i % 10));
+				CHECK_TRUE(devman.add_device(crunes_t(name), &sTestFileDevice));
+			}
+			CHECK_TRUE(devman.add_alias("data:\\", crunes_t("D17:\\data\\")));
+			CHECK_TRUE(devman.add_alias("textures:\\", crunes_t("data:\\textures\\")));
+
+			CHECK_TRUE(devman.has_device(path_t(&ctxt, crunes_t("D39:\\readme.txt"))));
+			CHECK_TRUE(devman.has_device(path_t(&ctxt, crunes_t("textures:\\a.png"))));
+			CHECK_FALSE(devman.has_device(path_t(&ctxt, crunes_t("D40:\\readme.txt"))));
+			CHECK_EQUAL(-1, devman.find_indexof_alias(crunes_t("D17:\\")));
+			CHECK_EQUAL(17, devman.find_indexof_device(crunes_t("D17:\\")));
+
+			path_t syspath(&ctxt);
+			CHECK_TRUE(devman.find_device(crunes_t("textures:\\a.png"), syspath) == &sTestFileDevice);
+			CHECK_EQUAL(0, compare(syspath.m_path, crunes_t("D17:\\data\\textures\\a.png")));
+			CHECK_TRUE(devman.find_device(crunes_t("D05:/docs/tech.txt"), syspath) == &sTestFileDevice);
+			CHECK_EQUAL(0, compare(syspath.m_path, crunes_t("D05:\\docs\\tech.txt")));
+			CHECK_TRUE(devman.find_device(crunes_t("nodevice:\\docs\\tech.txt"), syspath) == nullptr);
+
+			// Resolution into views and into a fixed buffer
+			path_t   path(&ctxt, crunes_t("textures:\\a.png"));
+			crunes_t prefix, relative;
+			CHECK_TRUE(devman.find_device(path, prefix, relative) == &sTestFileDevice);
+			CHECK_EQUAL(0, compare(prefix, crunes_t("D17:\\data\\textures\\")));
+			CHECK_EQUAL(0, compare(relative, crunes_t("a.png")));
+
+			runez_t<utf32::rune, 32> buffer;
+			CHECK_TRUE(devman.find_device(path, buffer) == &sTestFileDevice);
+			CHECK_EQUAL(0, compare(buffer, crunes_t("D17:\\data\\textures\\a.png")));
+			runez_t<utf32::rune, 16> small;
+			CHECK_TRUE(devman.find_device(path, small) == nullptr);
+
+			devman.clear();
+			CHECK_FALSE(devman.has_device(path_t(&ctxt, crunes_t("D05:\\docs"))));
+		}
 	}
 }
 UNITTEST_SUITE_END
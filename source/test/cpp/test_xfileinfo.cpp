@@ -4,12 +4,14 @@
 
 #include "xunittest/xunittest.h"
 
+#include "xfilesystem/private/x_checksum.h"
 #include "xfilesystem/private/x_filedevice.h"
 #include "xfilesystem/x_filesystem.h"
 #include "xfilesystem/x_filepath.h"
 #include "xfilesystem/x_dirpath.h"
 #include "xfilesystem/x_dirinfo.h"
 #include "xfilesystem/x_fileinfo.h"
+#include "xfilesystem/x_pathview.h"
 #include "xfilesystem/x_stream.h"
 
 using namespace xcore;
@@ -56,6 +58,26 @@ UNITTEST_SUITE_BEGIN(fileinfo)
 			CHECK_TRUE(fi1 == fi2);
 		}
 
+		UNITTEST_TEST(view)
+		{
+			filepath_view v1("TEST:/textfiles//authors.txt");
+			CHECK_TRUE(v1.isValid());
+			CHECK_TRUE(v1.isRooted());
+			CHECK_TRUE(filesystem_t::exists(v1));
+			CHECK_FALSE(filesystem_t::exists(filepath_view("TEST:\\textfiles\\nothere.txt")));
+
+			filepath_t fp1 = filesystem_t::filepath("TEST:\\textfiles\\authors.txt");
+			fileinfo_t fi1(fp1);
+			CHECK_EQUAL((s64)fi1.getLength(), filesystem_t::size(v1));
+			CHECK_EQUAL((s64)-1, filesystem_t::size(filepath_view("TEST:\\textfiles\\nothere.txt")));
+			CHECK_TRUE(filesystem_t::exists(dirpath_view("TEST:\\textfiles\\")));
+
+			CHECK_FALSE(filepath_view("").isValid());
+			CHECK_FALSE(filepath_view("TEST:\\*.txt").isValid());
+			CHECK_FALSE(filepath_view("TEST:\\a:b.txt").isValid());
+			CHECK_FALSE(filepath_view("textfiles\\authors.txt").isRooted());
+		}
+
 		UNITTEST_TEST(sCopy)
 		{
 			const char* filename1 = "TEST:\\textfiles\\authors.txt";
@@ -80,6 +102,50 @@ UNITTEST_SUITE_BEGIN(fileinfo)
 			CHECK_TRUE(fileinfo_t::sMove(fp1,fp2));
 			CHECK_FALSE(fileinfo_t::sExists(fp1));
 		}
+
+		UNITTEST_TEST(sChecksum)
+		{
+			const char* filename = "TEST:\\textfiles\\docs\\tech.txt";
+			filepath_t fp1 = filesystem_t::filepath(filename);
+			CHECK_TRUE(fileinfo_t::sExists(fp1));
+
+			stream_t fs1 = filesystem_t::open(fp1, FileMode_Open, FileAccess_Read, FileOp_Sync);
+			stream_t cs1 = xstream_checksum(fs1, Checksum_CRC32C);
+			xbyte buffer[100];
+			while (cs1.read(buffer, sizeof(buffer)) > 0) {}
+			u64 const digest = cs1.digest();
+			cs1.close();
+
+			CHECK_EQUAL(digest, fileinfo_t::sChecksum(fp1, Checksum_CRC32C));
+			CHECK_TRUE(digest != 0);
+			CHECK_TRUE(fileinfo_t::sChecksum(fp1, Checksum_CRC32C) != fileinfo_t::sChecksum(fp1, Checksum_XXH64));
+		}
+
+		UNITTEST_TEST(checksum_reference)
+		{
+			xbyte const* check = (xbyte const*)"123456789";
+			xbyte        data[512];
+			for (s32 i = 0; i < 512; ++i)
+				data[i] = (xbyte)i;
+
+			checksum_t crc(Checksum_CRC32C);
+			CHECK_EQUAL(0, crc.digest());
+			crc.update(check, 9);
+			CHECK_EQUAL(0xE3069283, crc.digest());
+			crc.reset(Checksum_CRC32C);
+			crc.update(data, 3);
+			crc.update(data + 3, 509);
+			CHECK_EQUAL(0xAE10EE5A, crc.digest());
+
+			checksum_t xxh(Checksum_XXH64);
+			CHECK_TRUE(xxh.digest() == 0xEF46DB3751D8E999ULL);
+			xxh.update(check, 9);
+			CHECK_TRUE(xxh.digest() == 0x8CB841DB40E6AE83ULL);
+			xxh.reset(Checksum_XXH64);
+			xxh.update(data, 100);
+			xxh.update(data + 100, 412);
+			CHECK_TRUE(xxh.digest() == 0x7B3BFCAAC0348AC0ULL);
+		}
 	}
 }
 UNITTEST_SUITE_END
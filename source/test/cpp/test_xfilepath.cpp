@@ -5,15 +5,23 @@
 #include "xunittest/xunittest.h"
 
 #include "xfilesystem/private/x_filedevice.h"
+#include "xfilesystem/private/x_filesystem.h"
+#include "xfilesystem/private/x_path.h"
+#include "xfilesystem/private/x_pathtable.h"
+#include "xfilesystem/private/x_stralloc.h"
 #include "xfilesystem/x_filesystem.h"
 #include "xfilesystem/x_filepath.h"
 #include "xfilesystem/x_dirpath.h"
 #include "xfilesystem/x_dirinfo.h"
 #include "xfilesystem/x_fileinfo.h"
+#include "xfilesystem/x_patharena.h"
+#include "xfilesystem/x_pathliteral.h"
 #include "xfilesystem/x_stream.h"
 
 using namespace xcore;
 
+extern xcore::alloc_t* gTestAllocator;
+
 UNITTEST_SUITE_BEGIN(filepath)
 {
 	UNITTEST_FIXTURE(main)
@@ -36,6 +44,272 @@ UNITTEST_SUITE_BEGIN(filepath)
 			CHECK_FALSE(p.isEmpty());
 		}
 
+		UNITTEST_TEST(short_and_long)
+		{
+			// The short path is stored inline, the long one does not fit and is allocated
+			const char* shortstr = "TEST:\\textfiles\\docs\\readme.txt";
+			const char* longstr = "TEST:\\textfiles\\docs\\a\\very\\long\\path\\that\\does\\not\\fit\\in\\the\\inline\\buffer\\of\\the\\path\\and\\is\\allocated\\readme.txt";
+			filepath_t s1 = filesystem_t::filepath(shortstr);
+			filepath_t l1 = filesystem_t::filepath(longstr);
+
+			filepath_t s2(s1);
+			filepath_t l2(l1);
+			CHECK_TRUE(s1 == s2);
+			CHECK_TRUE(l1 == l2);
+			CHECK_TRUE(s1 != l1);
+
+			s2 = l1;
+			l2 = s1;
+			CHECK_TRUE(s2 == l1);
+			CHECK_TRUE(l2 == s1);
+		}
+
+		UNITTEST_TEST(move)
+		{
+			const char* shortstr = "TEST:\\textfiles\\docs\\";
+			const char* longstr = "TEST:\\textfiles\\docs\\a\\very\\long\\path\\that\\does\\not\\fit\\in\\the\\inline\\buffer\\of\\the\\path\\and\\is\\allocated\\";
+			dirpath_t s1 = filesystem_t::dirpath(shortstr);
+			dirpath_t l1 = filesystem_t::dirpath(longstr);
+
+			// The moved-from path is left empty, the index moves along with the runes
+			dirpath_t s2(static_cast<dirpath_t&&>(s1));
+			dirpath_t l2(static_cast<dirpath_t&&>(l1));
+			CHECK_TRUE(s1.isEmpty());
+			CHECK_TRUE(l1.isEmpty());
+			CHECK_TRUE(s2 == filesystem_t::dirpath(shortstr));
+			CHECK_TRUE(l2 == filesystem_t::dirpath(longstr));
+			CHECK_EQUAL(2, s2.getLevels());
+			CHECK_EQUAL(20, l2.getLevels());
+
+			s1 = static_cast<dirpath_t&&>(l2);
+			l1 = static_cast<dirpath_t&&>(s2);
+			CHECK_TRUE(s1 == filesystem_t::dirpath(longstr));
+			CHECK_TRUE(l1 == filesystem_t::dirpath(shortstr));
+			CHECK_EQUAL(20, s1.getLevels());
+			CHECK_EQUAL(2, l1.getLevels());
+		}
+
+		UNITTEST_TEST(arena)
+		{
+			const char* longstr = "TEST:\\textfiles\\docs\\a\\very\\long\\path\\that\\does\\not\\fit\\in\\the\\inline\\buffer\\of\\the\\path\\and\\is\\allocated\\readme.txt";
+			filepath_t outside = filesystem_t::filepath(longstr);
+			{
+				path_arena arena(gTestAllocator, 4096);
+				CHECK_TRUE(path_arena::current() == &arena);
+
+				filepath_t inside = filesystem_t::filepath(longstr);
+				CHECK_TRUE(arena.owns(filesys_t::get_path(inside).m_path.m_runes.m_ascii.m_bos));
+				CHECK_FALSE(arena.owns(filesys_t::get_path(outside).m_path.m_runes.m_ascii.m_bos));
+				CHECK_TRUE(inside == outside);
+
+				// Paths that fit the inline buffer do not use the arena
+				filepath_t shortpath = filesystem_t::filepath("TEST:\\readme.txt");
+				CHECK_TRUE(filesys_t::get_path(shortpath).is_inline());
+
+				// A path that the library keeps moves out of the arena, also when a path is moved into it
+				filepath_t kept = filesystem_t::filepath("TEST:\\readme.txt");
+				filesys_t::get_path(kept).set_persistent();
+				filesys_t::get_path(kept) = static_cast<path_t&&>(filesys_t::get_path(inside));
+				CHECK_FALSE(arena.owns(filesys_t::get_path(kept).m_path.m_runes.m_ascii.m_bos));
+				CHECK_TRUE(kept == outside);
+			}
+			CHECK_TRUE(path_arena::current() == nullptr);
+		}
+
+		UNITTEST_TEST(stralloc)
+		{
+			stralloc_t* sa = gTestAllocator->construct<stralloc_t>(gTestAllocator, utf32::TYPE);
+
+			// A freed buffer is handed out again by the cache of the thread
+			runes_t r1 = sa->allocate(10, 20, utf32::TYPE);
+			CHECK_EQUAL(utf32::TYPE, r1.m_type);
+			CHECK_EQUAL(10, r1.size());
+			CHECK_TRUE(r1.cap() >= 20);
+			utf32::prune const p1 = r1.m_runes.m_utf32.m_bos;
+			sa->deallocate(r1);
+			CHECK_TRUE(r1.is_nil());
+			runes_t r2 = sa->allocate(12, 24, utf32::TYPE);
+			CHECK_TRUE(r2.m_runes.m_utf32.m_bos == p1);
+
+			// Too large for the size classes
+			runes_t r3 = sa->allocate(2000, 2000, utf32::TYPE);
+			CHECK_EQUAL(2000, r3.size());
+
+			sa->deallocate(r2);
+			sa->deallocate(r3);
+
+			// A thread that uses two allocators in turn keeps the cache of both
+			stralloc_t* sb = gTestAllocator->construct<stralloc_t>(gTestAllocator, utf32::TYPE);
+			runes_t ra = sa->allocate(10, 20, utf32::TYPE);
+			utf32::prune const pa = ra.m_runes.m_utf32.m_bos;
+			sa->deallocate(ra);
+			runes_t rb = sb->allocate(10, 20, utf32::TYPE);
+			utf32::prune const pb = rb.m_runes.m_utf32.m_bos;
+			sb->deallocate(rb);
+			ra = sa->allocate(10, 20, utf32::TYPE);
+			rb = sb->allocate(10, 20, utf32::TYPE);
+			CHECK_TRUE(ra.m_runes.m_utf32.m_bos == pa);
+			CHECK_TRUE(rb.m_runes.m_utf32.m_bos == pb);
+			sa->deallocate(ra);
+			sb->deallocate(rb);
+			gTestAllocator->destruct(sb);
+			gTestAllocator->destruct(sa);
+
+			// Also with more allocators than the thread keeps caches for, the cache of an allocator is used again
+			stralloc_t*  many[stralloc_t::THREAD_CACHES + 2];
+			utf32::prune first[stralloc_t::THREAD_CACHES + 2];
+			for (s32 round = 0; round < 2; ++round)
+			{
+				for (s32 i = 0; i < stralloc_t::THREAD_CACHES + 2; ++i)
+				{
+					if (round == 0)
+						many[i] = gTestAllocator->construct<stralloc_t>(gTestAllocator, utf32::TYPE);
+					runes_t r = many[i]->allocate(10, 20, utf32::TYPE);
+					if (round == 0)
+						first[i] = r.m_runes.m_utf32.m_bos;
+					else
+						CHECK_TRUE(r.m_runes.m_utf32.m_bos == first[i]);
+					many[i]->deallocate(r);
+				}
+			}
+			for (s32 i = 0; i < stralloc_t::THREAD_CACHES + 2; ++i)
+				gTestAllocator->destruct(many[i]);
+		}
+
+		UNITTEST_TEST(normalize)
+		{
+			filepath_t p1 = filesystem_t::filepath("TEST:/textfiles//docs/./old/../readme.txt");
+			filepath_t p2 = filesystem_t::filepath("TEST:\\textfiles\\docs\\readme.txt");
+			CHECK_TRUE(p1 == p2);
+
+			filepath_t p3 = filesystem_t::filepath("TEST:\\..\\..\\textfiles\\docs\\readme.txt\\");
+			CHECK_TRUE(p3 == p2);
+
+			filepath_t p4 = filesystem_t::filepath("../../textfiles/docs/.hidden");
+			filepath_t p5 = filesystem_t::filepath("..\\..\\textfiles\\docs\\.hidden");
+			CHECK_TRUE(p4 == p5);
+		}
+
+		UNITTEST_TEST(hash)
+		{
+			filepath_t p1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\readme.txt");
+			filepath_t p2 = filesystem_t::filepath("TEST:/textfiles/docs/readme.txt");
+			filepath_t p3 = filesystem_t::filepath("TEST:\\TextFiles\\Docs\\ReadMe.txt");
+			CHECK_TRUE(p1.hash() == p2.hash());
+			CHECK_TRUE(p1.hash() != p3.hash());
+			CHECK_TRUE(p1.hash_folded() == p3.hash_folded());
+			CHECK_FALSE(p1 == p3);
+
+			// The cached hash follows changes to the path
+			u64 const h = p2.hash();
+			p2.makeRelative();
+			CHECK_TRUE(p2.hash() != h);
+			CHECK_TRUE(p2 != p1);
+
+			// Paths stored as utf8 hash the same as paths stored as utf32
+			filesystem_t::context_t ctxt;
+			ctxt.m_path_type = utf8::TYPE;
+			path_t p4(&ctxt, crunes_t("TEST:\\textfiles\\docs\\readme.txt"));
+			CHECK_TRUE(p4.hash() == p1.hash());
+			CHECK_TRUE(p4.hash() == path_t::hash(crunes_t("TEST:\\textfiles\\docs\\readme.txt"), false));
+		}
+
+#ifdef XPATH_LITERAL
+		UNITTEST_TEST(literal)
+		{
+			static constexpr auto sReadMe = XPATH_LITERAL("TEST:/textfiles//docs/./old/../readme.txt");
+			static_assert(sReadMe.m_levels == 3, "levels are counted by the compiler");
+			static_assert(sReadMe.m_device == 6, "'TEST:\\' is the device part");
+
+			filepath_t p1 = filesystem_t::filepath(sReadMe);
+			filepath_t p2 = filesystem_t::filepath("TEST:\\textfiles\\docs\\readme.txt");
+			CHECK_TRUE(p1 == p2);
+			CHECK_TRUE(p1.hash() == p2.hash());
+			CHECK_TRUE(p1.hash_folded() == p2.hash_folded());
+			CHECK_EQUAL(sReadMe.m_hash, p2.hash());
+
+			// Filename and extension are slices of the level index that came with the literal
+			filepath_t f1, f2;
+			p1.getFilename(f1);
+			p2.getFilename(f2);
+			CHECK_TRUE(f1 == f2);
+			p1.getExtension(f1);
+			p2.getExtension(f2);
+			CHECK_TRUE(f1 == f2);
+
+			static constexpr auto sDocs = XPATH_LITERAL("textfiles\\docs\\");
+			dirpath_t d1 = filesystem_t::dirpath(sDocs);
+			dirpath_t d2 = filesystem_t::dirpath("textfiles\\docs");
+			CHECK_TRUE(d1 == d2);
+			CHECK_FALSE(sDocs.view().isRooted());
+			CHECK_TRUE(sReadMe.view().isValid());
+		}
+#endif
+
+		UNITTEST_TEST(intern)
+		{
+			filepath_t p1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\readme.txt");
+			filepath_t p2 = filesystem_t::filepath("TEST:\\textfiles\\docs\\readme.txt");
+			filepath_t p3 = filesystem_t::filepath("TEST:\\textfiles\\readme.txt");
+			dirpath_t  d1 = filesystem_t::dirpath("TEST:\\textfiles\\docs");
+
+			u32 const id1 = filesystem_t::intern(p1);
+			u32 const id2 = filesystem_t::intern(p2);
+			u32 const id3 = filesystem_t::intern(p3);
+			CHECK_TRUE(id1 != 0);
+			CHECK_EQUAL(id1, id2);
+			CHECK_TRUE(id1 != id3);
+			CHECK_EQUAL(filesystem_t::intern(d1), filesystem_t::parent(id1));
+			CHECK_EQUAL(filesystem_t::parent(filesystem_t::parent(id1)), filesystem_t::parent(id3));
+
+			filepath_t p4(id1);
+			CHECK_TRUE(p4 == p1);
+			dirpath_t d2(filesystem_t::parent(id1));
+			CHECK_TRUE(d2 == d1);
+		}
+
+		UNITTEST_TEST(intern_encoding)
+		{
+			// The same name in UTF-8 and in UTF-32 is one name
+			filesystem_t::context_t ctxt;
+			ctxt.m_allocator = gTestAllocator;
+			stralloc_t* sa   = gTestAllocator->construct<stralloc_t>(gTestAllocator, utf32::TYPE);
+			ctxt.m_stralloc  = sa;
+			ctxt.m_path_type = utf32::TYPE;
+			pathtable_t* table = gTestAllocator->construct<pathtable_t>(&ctxt);
+
+			utf8::rune const  name8[]  = {0xC3, 0xA9, 't', 0xC3, 0xA9, 0};
+			utf32::rune const name32[] = {0xE9, 't', 0xE9, 0};
+			u32 const id8  = table->intern(0, crunes_t(name8, name8 + 5));
+			u32 const id32 = table->intern(0, crunes_t(name32, name32 + 3));
+			CHECK_TRUE(id8 != 0);
+			CHECK_EQUAL(id8, id32);
+
+			gTestAllocator->destruct(table);
+			gTestAllocator->destruct(sa);
+		}
+
+		UNITTEST_TEST(utf8)
+		{
+			// Paths that fit the inline buffer never reach the string allocator
+			filesystem_t::context_t ctxt;
+			ctxt.m_path_type = utf8::TYPE;
+
+			path_t p(&ctxt, crunes_t("TEST:\\textfiles\\docs\\readme.txt"));
+			CHECK_EQUAL(utf8::TYPE, p.m_path.m_type);
+			CHECK_TRUE(p.is_inline());
+			CHECK_TRUE(p.isRooted());
+
+			path_t filename(&ctxt);
+			p.getFilename(filename);
+			CHECK_EQUAL(utf8::TYPE, filename.m_path.m_type);
+			CHECK_EQUAL(0, compare(filename.m_path, crunes_t("readme.txt")));
+
+			path_t ext(&ctxt);
+			p.getExtension(ext);
+			CHECK_EQUAL(0, compare(ext.m_path, crunes_t(".txt")));
+		}
+
 	}
 }
 UNITTEST_SUITE_END
@@ -14,6 +14,8 @@
 
 using namespace xcore;
 
+extern xcore::alloc_t* gTestAllocator;
+
 
 UNITTEST_SUITE_BEGIN(filestream)
 {
@@ -206,6 +208,26 @@ UNITTEST_SUITE_BEGIN(filestream)
 			CHECK_EQUAL(10,fileLen1);
 		}
 
+		UNITTEST_TEST(reader)
+		{
+			const char* str1 = "TEST:\\textfiles\\docs\\tech.txt";
+			filepath_t xfp1 = filesystem_t::filepath(str1);
+			stream_t xfs1 = filesystem_t::open(xfp1,FileMode_Open,FileAccess_Read,FileOp_Sync);
+			xbyte buffer1[10];
+			CHECK_EQUAL(10, xfs1.read(buffer1, 10));
+			xfs1.setPos(0);
+
+			reader_t* reader = xfs1.get_reader();
+			xbyte buffer2[10];
+			CHECK_EQUAL(10, reader->read(buffer2, 10));
+			CHECK_EQUAL(10, xfs1.getPos());
+			for(int n = 0; n<10;++n)
+			{
+				CHECK_EQUAL(buffer1[n],buffer2[n]);
+			}
+			xfs1.close();
+		}
+
 		UNITTEST_TEST(readByte)
 		{
 			const char* str1 = "TEST:\\textfiles\\docs\\tech.txt";
@@ -252,6 +274,334 @@ UNITTEST_SUITE_BEGIN(filestream)
 			xfs1.write((xbyte const*)"T", 1);
 		}
 
+		UNITTEST_TEST(writeBuffered)
+		{
+			const char* str1 = "TEST:\\textfiles\\docs\\tech.txt";
+			filepath_t xfp1 = filesystem_t::filepath(str1);
+			stream_t xfs1 = filesystem_t::open(xfp1,FileMode_Open,FileAccess_ReadWrite,FileOp_Buffered);
+			xbyte buffer1[10];
+			xfs1.read(buffer1, 10);
+			xfs1.setPos(0);
+			for(int n = 0; n<10;++n)
+			{
+				CHECK_EQUAL(1, xfs1.write((xbyte const*)"abcdefghij" + n, 1));
+			}
+			xfs1.flush();
+
+			xbyte buffer_read[10];
+			xfs1.setPos(0);
+			u64 len = xfs1.read(buffer_read, 10);
+			CHECK_EQUAL(10, len);
+			for(int n = 0; n<10;++n)
+			{
+				CHECK_EQUAL('a' + n, buffer_read[n]);
+			}
+			xfs1.setPos(0);
+			xfs1.write(buffer1, 10);
+			xfs1.close();
+		}
+
+		UNITTEST_TEST(memoryBuffer)
+		{
+			xbyte data[16] = "0123456789";
+			buffer_t buffer(16, data);
+			stream_t xfs1 = filesystem_t::open(buffer, FileAccess_ReadWrite);
+			CHECK_TRUE(xfs1.isOpen());
+			CHECK_EQUAL(16, xfs1.getLength());
+
+			xbyte const* borrowed = xfs1.borrow(4);
+			CHECK_TRUE(borrowed == &data[0]);
+			CHECK_EQUAL(4, xfs1.getPos());
+			CHECK_TRUE(xfs1.borrow(16) == nullptr);
+
+			CHECK_EQUAL(2, xfs1.write((xbyte const*)"ab", 2));
+			CHECK_EQUAL('a', data[4]);
+			xfs1.setPos(14);
+			CHECK_EQUAL(2, xfs1.write((xbyte const*)"cdef", 4));
+			xfs1.close();
+		}
+
+		UNITTEST_TEST(memoryArena)
+		{
+			stream_t xfs1 = filesystem_t::open(gTestAllocator, 4);
+			CHECK_EQUAL(0, xfs1.getLength());
+			for(int n = 0; n<10;++n)
+			{
+				CHECK_EQUAL(10, xfs1.write((xbyte const*)"0123456789", 10));
+			}
+			CHECK_EQUAL(100, xfs1.getLength());
+
+			xfs1.setPos(0);
+			xbyte buffer[10];
+			CHECK_EQUAL(10, xfs1.read(buffer, 10));
+			CHECK_EQUAL('9', buffer[9]);
+			xfs1.close();
+		}
+
+		UNITTEST_TEST(maxOpenFiles)
+		{
+			// The filesystem of the tests is created with the default number of file handles
+			filesystem_t::context_t ctxt;
+			s32 const max = (s32)ctxt.m_max_file_handles;
+
+			xbyte data[4];
+			buffer_t buffer(4, data);
+			stream_t** streams = (stream_t**)gTestAllocator->allocate(sizeof(stream_t*) * (max + 1));
+			s32  n    = 0;
+			bool full = false;
+			while (n <= max)
+			{
+				streams[n] = gTestAllocator->construct<stream_t>(filesystem_t::open(buffer, FileAccess_Read));
+				if (!streams[n]->isOpen())
+				{
+					full = true;
+					break;
+				}
+				n += 1;
+			}
+			CHECK_TRUE(full);
+			CHECK_TRUE(n > 0 && n <= max);
+
+			// Closing one makes room for another
+			streams[0]->close();
+			stream_t xfs1 = filesystem_t::open(buffer, FileAccess_Read);
+			CHECK_TRUE(xfs1.isOpen());
+			xfs1.close();
+
+			s32 const count = full ? (n + 1) : n;
+			for (s32 i = 0; i < count; ++i)
+			{
+				gTestAllocator->destruct(streams[i]);
+			}
+			gTestAllocator->deallocate(streams);
+		}
+
+		UNITTEST_TEST(reopen)
+		{
+			// More streams than OS handles (m_max_open_files), the least recently used are closed and opened again
+			filepath_t xfp1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\tech.txt");
+			stream_t* streams[40];
+			for (s32 i = 0; i < 40; ++i)
+			{
+				streams[i] = gTestAllocator->construct<stream_t>(filesystem_t::open(xfp1, FileMode_Open, FileAccess_ReadWrite, FileOp_Sync));
+				CHECK_TRUE(streams[i]->isOpen());
+			}
+
+			xbyte buffer1[10];
+			xbyte buffer2[10];
+			CHECK_EQUAL(10, streams[39]->read(buffer1, 10));
+			CHECK_EQUAL(10, streams[0]->read(buffer2, 10));
+			for (s32 n = 0; n < 10; ++n)
+			{
+				CHECK_EQUAL(buffer1[n], buffer2[n]);
+			}
+			CHECK_EQUAL(10, streams[0]->getPos());
+
+			for (s32 i = 0; i < 40; ++i)
+			{
+				gTestAllocator->destruct(streams[i]);
+			}
+		}
+
+		UNITTEST_TEST(shared)
+		{
+			// Read-only streams of the same file share the file handle but not the position
+			filepath_t xfp1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\tech.txt");
+			stream_t xfs1 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_Read, FileOp_Sync);
+			stream_t xfs2 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_Read, FileOp_Sync);
+			CHECK_TRUE(xfs1.isOpen());
+			CHECK_TRUE(xfs2.isOpen());
+
+			xbyte buffer1[10];
+			xbyte buffer2[10];
+			CHECK_EQUAL(10, xfs1.read(buffer1, 10));
+			CHECK_EQUAL(10, xfs1.getPos());
+			CHECK_EQUAL(0, xfs2.getPos());
+			CHECK_EQUAL(10, xfs2.read(buffer2, 10));
+			for (s32 n = 0; n < 10; ++n)
+			{
+				CHECK_EQUAL(buffer1[n], buffer2[n]);
+			}
+
+			xfs1.close();
+			CHECK_FALSE(xfs1.isOpen());
+			CHECK_TRUE(xfs2.isOpen());
+			CHECK_EQUAL(10, xfs2.read(buffer2, 10));
+			xfs2.close();
+		}
+
+		UNITTEST_TEST(sharedDecorated)
+		{
+			// Closing a decorated stream closes the decorator, the stream that shares the file handle stays open
+			filepath_t xfp1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\tech.txt");
+			stream_t xfs1 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_Read, FileOp_Sync);
+			stream_t xfs2 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_Read, FileOp_Sync);
+			stream_t xcs1 = xstream_checksum(xfs1, Checksum_CRC32C);
+			stream_t xcs2 = xcs1;
+			CHECK_FALSE(xfs1.isOpen());
+			CHECK_TRUE(xcs1.isOpen());
+
+			xbyte buffer1[10];
+			xbyte buffer2[10];
+			CHECK_EQUAL(10, xcs1.read(buffer1, 10));
+			xcs1.close();
+			CHECK_TRUE(xcs2.isOpen());
+			CHECK_TRUE(xcs2.digest() != 0);
+			xcs2.close();
+			CHECK_FALSE(xcs2.isOpen());
+
+			CHECK_TRUE(xfs2.isOpen());
+			CHECK_EQUAL(10, xfs2.read(buffer2, 10));
+			for (s32 n = 0; n < 10; ++n)
+			{
+				CHECK_EQUAL(buffer1[n], buffer2[n]);
+			}
+			xfs2.close();
+		}
+
+		UNITTEST_TEST(lazy)
+		{
+			filepath_t xfp1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\tech.txt");
+			stream_t xfs1 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_ReadWrite, FileOp_Sync);
+			stream_t xfs2 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_ReadWrite, FileOp_Lazy);
+			CHECK_TRUE(xfs2.isOpen());
+			CHECK_TRUE(xfs2.canRead());
+			CHECK_TRUE(xfs2.canWrite());
+			CHECK_EQUAL(xfs1.getLength(), xfs2.getLength());
+
+			xbyte buffer1[10];
+			xbyte buffer2[10];
+			CHECK_EQUAL(10, xfs1.read(buffer1, 10));
+			CHECK_EQUAL(10, xfs2.read(buffer2, 10));
+			for (s32 n = 0; n < 10; ++n)
+			{
+				CHECK_EQUAL(buffer1[n], buffer2[n]);
+			}
+			xfs1.close();
+			xfs2.close();
+		}
+
+		UNITTEST_TEST(lazyMissing)
+		{
+			// A lazily opened file is only opened on the first IO, a file that does not exist does no IO at all
+			filepath_t xfp1 = filesystem_t::filepath("TEST:\\textfiles\\docs\\missing.txt");
+			stream_t xfs1 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_ReadWrite, FileOp_Lazy);
+			CHECK_TRUE(xfs1.isOpen());
+
+			xbyte buffer[10];
+			CHECK_EQUAL(0, xfs1.read(buffer, 10));
+			CHECK_EQUAL(0, xfs1.write(buffer, 10));
+			CHECK_EQUAL(0, xfs1.getLength());
+			CHECK_EQUAL(0, xfs1.getPos());
+			xfs1.close();
+			CHECK_FALSE(xfs1.isOpen());
+
+			// A plain open of the same missing file does not find the handle of a lazy read-only open
+			stream_t xfs2 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_Read, FileOp_Lazy);
+			CHECK_TRUE(xfs2.isOpen());
+			stream_t xfs3 = filesystem_t::open(xfp1, FileMode_Open, FileAccess_Read, FileOp_Sync);
+			CHECK_FALSE(xfs3.isOpen());
+			xfs2.close();
+		}
+
+		UNITTEST_TEST(records)
+		{
+			const char* text = "first\nsecond record\n\nlast";
+			buffer_t text_buffer(25, (xbyte*)text);
+			stream_t xfs1 = filesystem_t::open(text_buffer, FileAccess_Read);
+
+			// A small buffer so that records have to be carried over a refill
+			xbyte record_buffer_data[16];
+			buffer_t record_buffer(16, record_buffer_data);
+			record_reader_t records(xfs1.get_reader(), record_buffer);
+
+			crunes_t record;
+			CHECK_TRUE(records.next(record));
+			CHECK_EQUAL(5, record.size());
+			CHECK_TRUE(records.next(record));
+			CHECK_EQUAL(13, record.size());
+			CHECK_EQUAL('s', record.m_runes.m_ascii.m_str[0]);
+			CHECK_TRUE(records.next(record));
+			CHECK_EQUAL(0, record.size());
+			CHECK_TRUE(records.next(record));
+			CHECK_EQUAL(4, record.size());
+			CHECK_EQUAL('l', record.m_runes.m_ascii.m_str[0]);
+			CHECK_FALSE(records.next(record));
+			xfs1.close();
+		}
+
+		UNITTEST_TEST(lz4)
+		{
+			const char* str1 = "TEST:\\textfiles\\docs\\tech.lz4";
+			filepath_t xfp1 = filesystem_t::filepath(str1);
+			stream_t xfs1 = filesystem_t::open(xfp1,FileMode_Create,FileAccess_ReadWrite,FileOp_Sync);
+			stream_t lz1 = xstream_lz4(xfs1, 1024);
+			CHECK_FALSE(xfs1.isOpen());
+			for(int n = 0; n<1000;++n)
+			{
+				CHECK_EQUAL(10, lz1.write((xbyte const*)"0123456789", 10));
+			}
+			CHECK_EQUAL(10000, lz1.getLength());
+			lz1.close();
+
+			stream_t xfs2 = filesystem_t::open(xfp1,FileMode_Open,FileAccess_Read,FileOp_Sync);
+			CHECK_TRUE(xfs2.getLength() < 10000);
+			stream_t lz2 = xstream_lz4(xfs2, 1024);
+			CHECK_EQUAL(10000, lz2.getLength());
+			lz2.setPos(5003);
+			xbyte buffer[10];
+			CHECK_EQUAL(10, lz2.read(buffer, 10));
+			for(int n = 0; n<10;++n)
+			{
+				CHECK_EQUAL('0' + ((n + 3) % 10), buffer[n]);
+			}
+			lz2.close();
+			CHECK_TRUE(fileinfo_t::sDelete(xfp1));
+		}
+
+		UNITTEST_TEST(subrange)
+		{
+			const char* str1 = "TEST:\\textfiles\\docs\\tech.txt";
+			filepath_t xfp1 = filesystem_t::filepath(str1);
+			stream_t xfs1 = filesystem_t::open(xfp1,FileMode_Open,FileAccess_Read,FileOp_Sync);
+			xbyte buffer1[20];
+			CHECK_EQUAL(20, xfs1.read(buffer1, 20));
+
+			stream_t sub1 = xstream_subrange(xfs1, 5, 10);
+			CHECK_TRUE(sub1.isOpen());
+			CHECK_EQUAL(10, sub1.getLength());
+			xfs1.close();
+
+			xbyte buffer2[20];
+			CHECK_EQUAL(10, sub1.read(buffer2, 20));
+			for(int n = 0; n < 10; ++n)
+			{
+				CHECK_EQUAL(buffer1[5 + n], buffer2[n]);
+			}
+			sub1.setPos(100);
+			CHECK_EQUAL(10, sub1.getPos());
+			CHECK_EQUAL(0, sub1.read(buffer2, 1));
+			sub1.close();
+		}
+
+		UNITTEST_TEST(subrangePastEnd)
+		{
+			// A range that reaches past the end of its parent is as long as what can be read
+			xbyte data[16];
+			buffer_t buffer(16, data);
+			stream_t xms1 = filesystem_t::open(buffer, FileAccess_Read);
+			stream_t sub1 = xstream_subrange(xms1, 10, 20);
+			stream_t sub2 = xstream_subrange(xms1, 20, 4);
+			CHECK_EQUAL(6, sub1.getLength());
+			CHECK_EQUAL(0, sub2.getLength());
+
+			xbyte buffer1[20];
+			CHECK_EQUAL(6, sub1.read(buffer1, 20));
+			sub2.close();
+			sub1.close();
+			xms1.close();
+		}
+
 		UNITTEST_TEST(copyTo1)
 		{
 			const char* str1 = "TEST:\\textfiles\\docs\\tech.txt";
@@ -308,6 +658,51 @@ UNITTEST_SUITE_BEGIN(filestream)
 			CHECK_TRUE(fileinfo_t::sDelete(xfp2));
 			CHECK_FALSE(fileinfo_t::sExists(xfp2));
 		}
+
+		class copy_progress_test_t : public copy_progress_t
+		{
+		public:
+			copy_progress_test_t() : m_calls(0), m_copied(0), m_total(0) {}
+			virtual void progress(u64 copied, u64 total) { m_calls += 1; m_copied = copied; m_total = total; }
+			s32 m_calls;
+			u64 m_copied;
+			u64 m_total;
+		};
+
+		UNITTEST_TEST(copyCount)
+		{
+			xbyte src_data[100];
+			for(int n = 0; n < 100; ++n)
+				src_data[n] = (xbyte)n;
+			buffer_t src_buffer(100, src_data);
+			stream_t xfs1 = filesystem_t::open(src_buffer, FileAccess_Read);
+			xfs1.setPos(10);
+			stream_t xfs2 = filesystem_t::open(gTestAllocator, 16);
+
+			xbyte stream_buffer_data[32];
+			buffer_t stream_buffer(32, stream_buffer_data);
+			copy_progress_test_t progress;
+			CHECK_EQUAL(50, xstream_copy(xfs1, xfs2, 50, stream_buffer, &progress));
+			CHECK_EQUAL(60, xfs1.getPos());
+			CHECK_EQUAL(50, xfs2.getLength());
+			CHECK_EQUAL(4, progress.m_calls);
+			CHECK_EQUAL(50, progress.m_copied);
+			CHECK_EQUAL(50, progress.m_total);
+
+			// Count is clamped to what is left in the source
+			CHECK_EQUAL(40, xstream_copy(xfs1, xfs2, 1000, stream_buffer));
+			CHECK_EQUAL(90, xfs2.getLength());
+
+			xfs2.setPos(0);
+			xbyte buffer[90];
+			CHECK_EQUAL(90, xfs2.read(buffer, 90));
+			for(int n = 0; n < 90; ++n)
+			{
+				CHECK_EQUAL(src_data[10 + n], buffer[n]);
+			}
+			xfs1.close();
+			xfs2.close();
+		}
 	}
 }
 UNITTEST_SUITE_END